@@ -2,194 +2,2129 @@
 
 #include <utility>
 #include <type_traits>
+#include <span>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
 
-// IMPORTANT: string matcher matches the longest match it finds and pays no attention to the order in which the strings are given in the spec
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// IMPORTANT: string matcher reports every match it finds, overlapping ones included, and pays no attention to the order in which
+// the strings are given in the spec. When multiple strings end at the same character, the longest one gets reported first.
 
 /*
-TODO: Although my textbook about the topic doesn't mention this possibility, I figure that this table DFA system could be improved
-with a bit of effort. Right now, we've got elements with next states and callback pointers. Basically, the table interpreter has to
-always be on the lookout for hitting an invalid element (one where none of the strings continue to match). When it does it has to call
-the callback function of the last match that it detected. This is easily done by storing the position in the input stream and the callback
-pointer everytime a final state for a string is hit while jumping through the table. When you hit an invalid element, all you have to do
-is call the stored callback pointer and pass in the stored input stream position as the argument.
-THE POSSIBLE IMPROVEMENT IS AS SUCH: The job of keeping track of the last match can be done for free by the table itself, given enough
-processing at compile-time. Obviously, this means longer compile times, but that probably won't be a big deal. Basically,
-whenever a string ends and the last element (the one that calls the callback) is put into the table. You now know that every
-invalid element from there on out must call it's callback, because from their POV, this is the latest match.
-I don't exactly know what the algorithm is going to look like, but you can figure one out to efficiently make all the invalid
-elements from there on out point to the last match. Each element is going to need something like an age property, so that,
-if there is a match after this match because one of the other strings has already put a match further up the chain, we can
-tell that the invalid elements that point to another callback have precedence over our proposed callback invalids.
-I've called it age, but that might not be an appropraite name. You could do it like this: the age stores how far away in the chain
-the actual end element that calls the callback is. You can only overwrite an callback invalid if the age is greater than the age
-you would put into that element. Something along those lines. You're also gonna need an extra column in the state table so that
-end of input event can trigger a callback in the table, then the interpreter doesn't really have to think at all.
-Also, each invalid element would also have to store the offset to the input stream position that should be applied before
-calling the callback. That way, the interpreter can read the offset, read the callback, subtract the offset from the current
-stream position, and then call the callback with that new position.
+NOTE: There used to be a big TODO here about making the table keep track of the last match by itself, so that the interpreter
+wouldn't have to store the last callback and input stream position and wait for an invalid element before reporting the longest match.
+That's done now, although differently than I described: the table is an Aho-Corasick automaton now (compile_to_table computes the
+failure links at compile-time and folds them into the elements), so there are no invalid elements anymore and every match is reported
+as soon as it's last character comes in. No waiting, no age property, no offsets, and no skipped spots in the input stream.
+The extra column I was talking about exists too, although it's used for the output chain instead of the end of input event, which
+isn't needed anymore because nothing is ever pending.
+The shortest match option TODO that was here is gone as well, it doesn't make sense when every match is reported anyway.
 */
 
-// TODO: I'm not sure exactly if the above TODO makes this optimization unnecessary, but you could add an option to find the shortest match
-// instead of the longest. That would remove the overhead that you're complaining about in the above comment.
-// Like I said, I don't know if it actually would do anything if we do the above, but if the system remains as it is right now,
-// it would certainly make things faster to interpret.
+namespace meta {
+
+	using size_t = std::size_t;
+
+	// NOTE: See srcembed for a detailed explanation of why this works. After reading that, you'll
+	// also understand that [[noreturn]] probably isn't useless here.
+	[[noreturn]] consteval void static_fail_with_msg(const char * const);
+
+	/*
+	   NOTE: The functions that read the spec are constexpr instead of consteval, so that specs can be read at runtime too (see
+	   meta_string_match_runtime.h), and those can't call static_fail_with_msg. They call this instead when something's wrong with the spec.
+	   At compile-time, it has the same effect: it isn't constexpr, so calling it stops the compilation, and the message is right there
+	   in the error. At runtime, it remembers the first message in string_matcher_spec_error (one per thread) and returns, and the caller
+	   carries on with something harmless, so that nothing reads past the end of the spec. Whoever started reading checks it afterwards.
+	*/
+	inline thread_local const char* string_matcher_spec_error = nullptr;
+
+	inline void spec_fail_with_msg(const char * const message) noexcept {
+		if (!string_matcher_spec_error) { string_matcher_spec_error = message; }
+	}
+
+	/*
+	   NOTE: Flags change how the spec is read (and how the matcher gets built). They go into the spec itself (see const_string), so that
+	   every function that looks at the spec knows about them without having to pass them around separately. Without any flags, a spec means exactly what it always
+	   meant, so nothing changes for existing specs. You can combine them with |.
+	*/
+	enum string_matcher_flags_t : unsigned {
+		no_flags = 0,
+		// NOTE: Letters match both their lowercase and their uppercase version (only in ASCII), inside character classes too.
+		case_insensitive = 1 << 0,
+		// NOTE: . matches any byte and [...] matches any of the bytes inside the brackets. Ranges like [0-9] work, and [^...] matches
+		// every byte that isn't inside the brackets. This makes ., [ and ] special, so they need a backslash if you want them literally
+		// (inside the brackets, ], -, ^ and \ need one).
+		character_classes = 1 << 1,
+		// NOTE: Not about reading the spec, this makes CREATE_META_STRING_MATCHER use string_matcher_switch_t instead of string_matcher_t,
+		// see there for when that's a good idea.
+		switch_dispatch = 1 << 2
+	};
+
+	struct const_string {
+		const char * const data;
+		const size_t length;
+		const unsigned flags;
+
+		template <size_t size>
+		constexpr const_string(const char (&string)[size], unsigned flags = no_flags) : data(string), length(size - 1), flags(flags) { }
+
+		constexpr const_string(const char* const data, size_t length, unsigned flags = no_flags) : data(data), length(length), flags(flags) { }
+
+		constexpr const char& operator[](size_t index) const { return data[index]; }
+
+		constexpr const_string offset_by(size_t offset) const { return const_string(data + offset, length - offset, flags); }
+
+		constexpr bool has_flag(string_matcher_flags_t flag) const { return flags & flag; }
+	};
+
+	inline constexpr size_t string_matcher_character_count = (size_t)(unsigned char)-1 + 1;
+	// NOTE: This is the num of values representable by char (which we elsewhere make sure is not bigger than 1 byte).
+	// The byte class map is this big, so that every possible byte of input has a class without any extra checks
+	// when following the table.
+
+	/*
+	   NOTE: A string in the spec is a sequence of elements, and every element matches exactly one byte of input. An element is
+	   a character, a backslash together with the character it escapes, or (with character_classes) a . or a [...] class.
+	   All the functions below walk the spec one element at a time, so this is the only place that knows what the syntax looks like.
+	   They also check the spec for errors while they're at it, so the first one to run (calculate_table_length) complains about
+	   anything that's wrong with it.
+	   NOTE: Any byte can be in the spec, not just ASCII. The matcher doesn't know anything about encodings, it matches bytes, so a UTF-8
+	   string literal simply turns into it's UTF-8 bytes and matches those, and binary stuff (magic numbers and such) can be written with
+	   \xHH (two hex digits, always). You could also use C++'s own \x escapes in the string literal, but those keep eating hex digits
+	   for as long as there are any, so "\x7fELF" isn't what it looks like, and a 0 byte in the middle of a string literal is easy to miss.
+	*/
+	constexpr unsigned char parse_hex_digit(unsigned char character) {
+		if (character >= '0' && character <= '9') { return character - '0'; }
+		if (character >= 'a' && character <= 'f') { return character - 'a' + 10; }
+		if (character >= 'A' && character <= 'F') { return character - 'A' + 10; }
+		spec_fail_with_msg("\\x in matcher specification has to be followed by exactly two hex digits");
+		return 0;
+	}
+
+	// NOTE: Reads the character at i (resolving the backslash if there is one) and moves i past it.
+	constexpr unsigned char read_spec_character(const const_string& meta_matcher_spec, size_t& i, bool inside_character_class) {
+		// NOTE: Using chars as array subscript would be an issue, since char is signed on most platforms and everything
+		// above 127 (all of UTF-8 that isn't ASCII, for example) would be a negative subscript, which is UB.
+		// IMPORTANT: So we convert everything to unsigned char right here, making the negativity issue irrelevant.
+		// That conversion is well defined (it wraps), so a byte that was -61 as a char is 195 afterwards, which is what it's supposed to be.
+		// SIDE-NOTE: The reason negative subscripts are UB is because pointer overflow/underflow is UB. If the array
+		// happens to be at the start of memory (it won't be on most machines, but the spec needs to be
+		// compatible with that situation), then negative subscript will underflow the resulting pointer, so not allowed.
+		// This is also why moving a pointer outside of the bounds of an object (like an array or a class or something)
+		// is undefined (UNLESS you've only moved it one past the end of the object, the spec defines this
+		// because one-past-the-end pointers are useful, this also means that no object will be right at the end
+		// of memory because there still has to be space for the possible one-past-the-end pointer).
+		// Note that you don't even have to dereference it, simply moving it past the one-past-the-end or before the
+		// start of the object will result in UB.
+		// Thankfully (although I didn't explicitly find the following in the standard, it makes sense and is necessary
+		// for many applications), pointing a pointer to a specific position by value and moving it around there,
+		// even though there might not exist an object there, is probably fine, since you're avoiding pointer overflow.
+		// TODO: Research and find out what is different about pointers from unsigned integers.
+		// I always thought pointers were basically integers that you dereference, so why is overflow undefined for them?
+		unsigned char character = meta_matcher_spec[i++];
+		if (character != '\\') { return character; }
+
+		if (i == meta_matcher_spec.length) {
+			spec_fail_with_msg("backslash ('\\') character cannot appear at end of matcher specification");
+			return 0;
+		}
+		character = meta_matcher_spec[i++];
+
+		// NOTE: Nested switches are technically less efficient than state tables,
+		// but it's not that big of a deal for now. The expressiveness of this outweighs
+		// it's cost, at least in compile-time.
+		switch (character) {
+		case '|': case '\\': return character;
+		case 'x':
+			if (meta_matcher_spec.length - i < 2) {
+				spec_fail_with_msg("\\x in matcher specification has to be followed by exactly two hex digits");
+				return 0;
+			}
+			character = parse_hex_digit(meta_matcher_spec[i]) * 16 + parse_hex_digit(meta_matcher_spec[i + 1]);
+			i += 2;
+			return character;
+		case '.': case '[': case ']': if (meta_matcher_spec.has_flag(character_classes)) { return character; } break;
+		case '-': case '^': if (inside_character_class) { return character; } break;
+		}
+		spec_fail_with_msg("invalid character following backslash ('\\') character in matcher specification");
+		return character;
+	}
+
+	constexpr bool is_ascii_letter(unsigned char character) { return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z'); }
+
+	// NOTE: Flips the case of an ASCII letter. The two cases are exactly 32 apart.
+	constexpr unsigned char flip_ascii_case(unsigned char character) { return character ^ 0x20; }
+
+	// NOTE: Calls byte_handler with every byte that the element starting at element_begin matches (every byte exactly once)
+	// and returns the index right after the element.
+	template <typename byte_handler_t>
+	constexpr size_t for_each_element_byte(const const_string& meta_matcher_spec, size_t element_begin, byte_handler_t&& byte_handler) {
+		size_t i = element_begin;
+		const bool has_character_classes = meta_matcher_spec.has_flag(character_classes);
+
+		if (has_character_classes && meta_matcher_spec[i] == '.') {
+			for (size_t character = 0; character < string_matcher_character_count; character++) { byte_handler((unsigned char)character); }
+			return i + 1;
+		}
+
+		if (!has_character_classes || meta_matcher_spec[i] != '[') {
+			const unsigned char character = read_spec_character(meta_matcher_spec, i, false);
+			byte_handler(character);
+			if (meta_matcher_spec.has_flag(case_insensitive) && is_ascii_letter(character)) { byte_handler(flip_ascii_case(character)); }
+			return i;
+		}
+
+		i++;
+		bool is_negated = false;
+		if (i != meta_matcher_spec.length && meta_matcher_spec[i] == '^') {
+			is_negated = true;
+			i++;
+		}
+
+		bool members[string_matcher_character_count] { };
+		bool is_empty = true;
+		while (true) {
+			if (i == meta_matcher_spec.length) {
+				spec_fail_with_msg("character class ('[') is missing it's closing bracket (']') in matcher specification");
+				return i;
+			}
+			if (meta_matcher_spec[i] == ']') {
+				i++;
+				break;
+			}
+
+			const unsigned char range_begin = read_spec_character(meta_matcher_spec, i, true);
+			unsigned char range_end = range_begin;
+			// NOTE: A - right before the closing bracket is simply a -.
+			if (i + 1 < meta_matcher_spec.length && meta_matcher_spec[i] == '-' && meta_matcher_spec[i + 1] != ']') {
+				i++;
+				range_end = read_spec_character(meta_matcher_spec, i, true);
+				if (range_end < range_begin) { spec_fail_with_msg("character class range is backwards (like z-a) in matcher specification"); }
+			}
+
+			for (size_t character = range_begin; character <= range_end; character++) {
+				members[character] = true;
+				if (meta_matcher_spec.has_flag(case_insensitive) && is_ascii_letter(character)) { members[flip_ascii_case(character)] = true; }
+			}
+			is_empty = false;
+		}
+		if (is_empty) { spec_fail_with_msg("empty character class ('[]') in matcher specification"); }
+
+		// NOTE: A negated class matches everything else, non-ASCII bytes included.
+		for (size_t character = 0; character < string_matcher_character_count; character++) {
+			if (members[character] != is_negated) { byte_handler((unsigned char)character); }
+		}
+		return i;
+	}
+
+	constexpr size_t find_element_end(const const_string& meta_matcher_spec, size_t element_begin) {
+		return for_each_element_byte(meta_matcher_spec, element_begin, [](unsigned char) { });
+	}
+
+	// NOTE: This checks the whole spec for errors and returns the number of elements in it (so the number of characters if you don't use
+	// any flags), which is 0 if there's nothing in it that could match.
+	constexpr size_t calculate_table_length(const const_string& meta_matcher_spec) {
+		size_t result = 0;
+
+		/*
+		   We could use pointers for this loop stuff instead of indices in the hopes of making compile times shorter,
+		   but who knows how much the compiler optimizes these functions before interpreting them anyway.
+		   I'm gonna simply rely on optimizations like I would if I were writing this for runtime, for the sake of expressiveness.
+		   If the compile times get too bad, I'll do something about it then, when I know for sure that it's necessary.
+		   One also has to remember, compilers will get better in the future and optimize these types of functions more and more,
+		   so this code will compile faster and faster.
+		*/
+		for (size_t i = 0; i < meta_matcher_spec.length; ) {
+			if (meta_matcher_spec[i] == '|') {
+				i++;
+				continue;
+			}
+			i = find_element_end(meta_matcher_spec, i);
+			result++;
+		}
+
+		return result;
+	}
+
+	// NOTE: The following couple of functions all take the index of the first character of a string in the spec (meaning the index
+	// right after a | character, or 0) and walk through that one string, one element at a time.
+	// They assume that calculate_table_length has already checked the spec for errors.
+	constexpr size_t find_string_end(const const_string& meta_matcher_spec, size_t string_begin) {
+		size_t i = string_begin;
+		while (i < meta_matcher_spec.length && meta_matcher_spec[i] != '|') { i = find_element_end(meta_matcher_spec, i); }
+		return i;
+	}
+
+	constexpr size_t calculate_string_length(const const_string& meta_matcher_spec, size_t string_begin) {
+		size_t result = 0;
+		for (size_t i = string_begin; i < meta_matcher_spec.length && meta_matcher_spec[i] != '|'; i = find_element_end(meta_matcher_spec, i)) { result++; }
+		return result;
+	}
+
+	// NOTE: Empty strings count too, they use up a match id (and a callback) even though they can never match.
+	constexpr size_t calculate_string_count(const const_string& meta_matcher_spec) {
+		size_t result = 1;
+		for (size_t string_end = find_string_end(meta_matcher_spec, 0); string_end != meta_matcher_spec.length;
+		     string_end = find_string_end(meta_matcher_spec, string_end + 1)) {
+			result++;
+		}
+		return result;
+	}
+
+	constexpr size_t calculate_longest_string_length(const const_string& meta_matcher_spec) {
+		size_t result = 0;
+		for (size_t string_begin = 0; ; ) {
+			const size_t string_length = calculate_string_length(meta_matcher_spec, string_begin);
+			if (string_length > result) { result = string_length; }
+
+			const size_t string_end = find_string_end(meta_matcher_spec, string_begin);
+			if (string_end == meta_matcher_spec.length) { return result; }
+			string_begin = string_end + 1;
+		}
+	}
+
+	/*
+	   NOTE: The table doesn't have a column for every character anymore, it has a column for every byte class instead.
+	   Two characters can share a column if every state in the table sends them to the same place, which is the case exactly when every
+	   element in the spec matches either both of them or neither of them. With plain strings, every character that appears in the spec
+	   gets it's own class and all the others share class 0. With case_insensitive, a letter shares it's class with the other case of itself,
+	   and with character_classes, something like [0-9] is only one class, as long as none of the digits show up anywhere else by themselves.
+	   The interpreter reads the class out of a 256 element map first and then uses it as the column.
+	   That's one extra load per character, but the map is tiny and always hot in the cache, and in exchange the table shrinks from
+	   256 columns to however many different classes your strings actually use (plus one), which is usually a dozen or so.
+	   The classes are worked out by starting with one class that contains everything and splitting it up with every element:
+	   every class that the element only partly covers gets split into the part that's covered and the part that isn't.
+	   Returns the number of classes.
+	*/
+	constexpr size_t calculate_byte_classes(const const_string& meta_matcher_spec, unsigned char (&byte_classes)[string_matcher_character_count]) {
+		size_t classes[string_matcher_character_count] { };
+		size_t class_sizes[string_matcher_character_count] { string_matcher_character_count };
+		size_t class_count = 1;
+
+		// NOTE: Per class bookkeeping for the element that's currently being looked at. Only the entries for the classes that
+		// the element touches get changed, and those get reset afterwards, so that we don't have to go through all 256 for every element.
+		constexpr size_t undecided = string_matcher_character_count;
+		size_t covered_counts[string_matcher_character_count] { };
+		size_t split_classes[string_matcher_character_count];
+		for (size_t byte_class = 0; byte_class < string_matcher_character_count; byte_class++) { split_classes[byte_class] = undecided; }
+
+		for (size_t i = 0; i < meta_matcher_spec.length; ) {
+			if (meta_matcher_spec[i] == '|') {
+				i++;
+				continue;
+			}
+
+			unsigned char element_bytes[string_matcher_character_count];
+			size_t element_byte_count = 0;
+			i = for_each_element_byte(meta_matcher_spec, i, [&](unsigned char character) { element_bytes[element_byte_count++] = character; });
+
+			size_t touched_classes[string_matcher_character_count];
+			size_t touched_class_count = 0;
+			for (size_t j = 0; j < element_byte_count; j++) {
+				const size_t byte_class = classes[element_bytes[j]];
+				if (covered_counts[byte_class]++ == 0) { touched_classes[touched_class_count++] = byte_class; }
+			}
+			for (size_t j = 0; j < element_byte_count; j++) {
+				const size_t old_class = classes[element_bytes[j]];
+				if (split_classes[old_class] == undecided) {
+					split_classes[old_class] = covered_counts[old_class] == class_sizes[old_class] ? old_class : class_count++;
+				}
+				const size_t new_class = split_classes[old_class];
+				if (new_class == old_class) { continue; }
+				classes[element_bytes[j]] = new_class;
+				class_sizes[old_class]--;
+				class_sizes[new_class]++;
+			}
+			for (size_t j = 0; j < touched_class_count; j++) {
+				covered_counts[touched_classes[j]] = 0;
+				split_classes[touched_classes[j]] = undecided;
+			}
+		}
+
+		for (size_t character = 0; character < string_matcher_character_count; character++) { byte_classes[character] = classes[character]; }
+		return class_count;
+	}
+
+	constexpr size_t calculate_byte_class_count(const const_string& meta_matcher_spec) {
+		unsigned char byte_classes[string_matcher_character_count];
+		return calculate_byte_classes(meta_matcher_spec, byte_classes);
+	}
+
+	/*
+	   NOTE: A growable array for compile-time functions. Since C++20, new and delete are allowed in constant expressions, as long as
+	   everything that gets allocated is deleted again before the evaluation is over (it can't leak into the program). That's exactly
+	   what we need for the trie below, whose size we don't know until we've built it.
+	   The name is a bit of a lie now, the table building functions are constexpr (so that they work at runtime as well, see
+	   meta_string_match_runtime.h), and so is this.
+	   There's std::vector of course, which is constexpr now as well, but I don't want to pull <vector> into every file that uses this
+	   header for a couple lines of code.
+	*/
+	template <typename element_t>
+	class compile_time_array_t {
+	public:
+		element_t* data = nullptr;
+		size_t size = 0;
+		size_t capacity = 0;
+
+		constexpr compile_time_array_t() = default;
+		compile_time_array_t(const compile_time_array_t&) = delete;
+		compile_time_array_t& operator=(const compile_time_array_t&) = delete;
+		constexpr ~compile_time_array_t() { delete[] data; }
+
+		constexpr void resize(size_t new_size, element_t fill_value) {
+			if (new_size > capacity) {
+				size_t new_capacity = capacity == 0 ? 16 : capacity * 2;
+				if (new_capacity < new_size) { new_capacity = new_size; }
+				element_t* new_data = new element_t[new_capacity];
+				for (size_t i = 0; i < size; i++) { new_data[i] = data[i]; }
+				delete[] data;
+				data = new_data;
+				capacity = new_capacity;
+			}
+			for (size_t i = size; i < new_size; i++) { data[i] = fill_value; }
+			size = new_size;
+		}
+
+		constexpr void push_back(element_t value) { resize(size + 1, value); }
+
+		constexpr void clear() { size = 0; }
+
+		constexpr void swap(compile_time_array_t& other) {
+			element_t* const other_data = other.data;
+			const size_t other_size = other.size;
+			const size_t other_capacity = other.capacity;
+			other.data = data;
+			other.size = size;
+			other.capacity = capacity;
+			data = other_data;
+			size = other_size;
+			capacity = other_capacity;
+		}
+
+		constexpr element_t& operator[](size_t index) { return data[index]; }
+		constexpr const element_t& operator[](size_t index) const { return data[index]; }
+	};
+
+	/*
+	   NOTE: Builds the trie (the goto function, as my textbook calls it) over byte classes instead of characters: children has
+	   class_count elements per row, one row per trie node, 0 meaning that there's no child there yet (the root is never anybody's child).
+	   It doesn't put the match ids into the nodes, it gives you the nodes every string ends in instead: the ones of string i are
+	   string_end_rows[string_end_row_begins[i]] up to string_end_rows[string_end_row_begins[i + 1]] (none for empty strings).
+	   assign_match_ids decides which ids end up where, see there.
+	   An element that matches more than one class (a [...], a ., a letter with case_insensitive that doesn't share it's class with
+	   it's other case) branches out into one child per class, so a string is really a whole bunch of strings, one for every combination,
+	   and they all share the same match id. That's what keeps matching at one table lookup per byte: the table doesn't know anything
+	   about classes, it's still just an Aho-Corasick automaton, only over a bigger set of strings.
+	   IMPORTANT: This means that every element with lots of classes in it multiplies the size of the table by the number of classes, so
+	   something like ...... in a spec with lots of different characters gets big fast. [0-9] is fine, it's usually only one class.
+	   Returns the number of strings, empty ones included.
+	*/
+	constexpr size_t build_trie(const const_string& meta_matcher_spec, const unsigned char (&byte_classes)[string_matcher_character_count], size_t class_count,
+				    compile_time_array_t<size_t>& children, compile_time_array_t<size_t>& string_end_rows,
+				    compile_time_array_t<size_t>& string_end_row_begins) {
+		children.resize(class_count, 0);		// the root row is always there
+		size_t node_count = 1;
+
+		compile_time_array_t<size_t> current_rows;	// every node the current string could be in right now
+		compile_time_array_t<size_t> next_rows;
+		current_rows.push_back(0);
+		string_end_row_begins.push_back(0);
+
+		for (size_t i = 0; ; ) {
+			if (i == meta_matcher_spec.length || meta_matcher_spec[i] == '|') {
+				// NOTE: Empty strings are simply skipped, they still use up a callback though. An empty string is the only way to
+				// still be in the root at the end of a string.
+				if (current_rows[0] != 0) {
+					for (size_t j = 0; j < current_rows.size; j++) { string_end_rows.push_back(current_rows[j]); }
+				}
+				string_end_row_begins.push_back(string_end_rows.size);		// NOTE: The last string (even if it's empty) still needs it's callback.
+				if (i == meta_matcher_spec.length) { return string_end_row_begins.size - 1; }
+
+				current_rows.clear();
+				current_rows.push_back(0);
+				i++;
+				continue;
+			}
+
+			bool element_classes[string_matcher_character_count] { };
+			i = for_each_element_byte(meta_matcher_spec, i, [&](unsigned char character) { element_classes[byte_classes[character]] = true; });
+
+			next_rows.clear();
+			for (size_t j = 0; j < current_rows.size; j++) {
+				const size_t row = current_rows[j];
+				for (size_t byte_class = 0; byte_class < class_count; byte_class++) {
+					if (!element_classes[byte_class]) { continue; }
+					// NOTE: No references into children here, adding a row can move it.
+					if (children[row * class_count + byte_class] == 0) {
+						children[row * class_count + byte_class] = node_count++;
+						children.resize(children.size + class_count, 0);
+					}
+					next_rows.push_back(children[row * class_count + byte_class]);
+				}
+			}
+			current_rows.swap(next_rows);
+		}
+	}
+
+	/*
+	   NOTE: Decides which match ids go into which states, from the string ends build_trie found.
+	   More than one string can end in the same trie node without being the same string: "a.c" and "abc" both end in the node for abc,
+	   and so do "[0-9][0-9]" and "12" (the node for 12). All of them have to be reported there. A state only has room for one match id
+	   though, so every id after the first one gets an extra state of it's own that's only there for the output chain (nothing ever
+	   transitions into it, compile_to_table gives it a copy of the node's row so that it's still a sensible state if you restore it):
+	   the node reports the first id and links to the extra state for the second one, which links to the one for the third one and so on,
+	   and the last one links to wherever the node's output chain would have gone anyway. The ids of one node are in spec order.
+	   Only strings that are really the same string get collapsed into one id, which is when they end in exactly the same nodes
+	   ("abc" twice, or "a" and "A" with case_insensitive, any element that covers the same classes is the same element). The last one
+	   of those wins, see the README.
+	   The extra states come right after the node_count nodes. own_match_ids is the first id of the strings that end exactly at the node
+	   (or the id of the extra state), own_chain_links is the extra state with the next id (0 if there isn't one), and chain_owners is
+	   the node an extra state belongs to.
+	*/
+	constexpr void assign_match_ids(size_t string_count, size_t node_count, size_t no_match_id, const compile_time_array_t<size_t>& string_end_rows,
+					const compile_time_array_t<size_t>& string_end_row_begins, compile_time_array_t<size_t>& own_match_ids,
+					compile_time_array_t<size_t>& own_chain_links, compile_time_array_t<size_t>& chain_owners) {
+		compile_time_array_t<size_t> chain_ends;	// the last state in the own chain of every node
+		own_match_ids.resize(node_count, no_match_id);
+		own_chain_links.resize(node_count, 0);
+		chain_owners.resize(node_count, 0);
+		chain_ends.resize(node_count, 0);
+		for (size_t match_id = 0; match_id < string_count; match_id++) {
+			const size_t end_rows_begin = string_end_row_begins[match_id];
+			const size_t end_row_count = string_end_row_begins[match_id + 1] - end_rows_begin;
+			if (end_row_count == 0) { continue; }
+
+			// NOTE: build_trie goes through the same classes in the same order for the same elements, so the same string ends in
+			// the same nodes in the same order, and comparing the lists is enough.
+			bool is_duplicate = false;
+			for (size_t later_match_id = match_id + 1; later_match_id < string_count && !is_duplicate; later_match_id++) {
+				const size_t later_end_rows_begin = string_end_row_begins[later_match_id];
+				if (string_end_row_begins[later_match_id + 1] - later_end_rows_begin != end_row_count) { continue; }
+				is_duplicate = true;
+				for (size_t j = 0; j < end_row_count && is_duplicate; j++) { is_duplicate = string_end_rows[end_rows_begin + j] == string_end_rows[later_end_rows_begin + j]; }
+			}
+			if (is_duplicate) { continue; }
+
+			for (size_t j = 0; j < end_row_count; j++) {
+				const size_t row = string_end_rows[end_rows_begin + j];
+				if (own_match_ids[row] == no_match_id) {
+					own_match_ids[row] = match_id;
+					chain_ends[row] = row;
+					continue;
+				}
+				const size_t extra_state = own_match_ids.size;
+				own_match_ids.push_back(match_id);
+				own_chain_links.push_back(0);
+				chain_owners.push_back(row);
+				own_chain_links[chain_ends[row]] = extra_state;
+				chain_ends[row] = extra_state;
+			}
+		}
+	}
+
+	/*
+	   NOTE: Gives every distinct signature (signature_length size_t's) a number, in the order in which they first show up, starting at 0.
+	   It's a plain open addressing hash table (FNV-1a, linear probing) over compile-time memory, for minimize_automaton below,
+	   which would take forever if it compared every signature with every other one.
+	*/
+	class compile_time_signature_table_t {
+	public:
+		size_t signature_length;
+		size_t count = 0;
+		compile_time_array_t<size_t> signatures;
+		compile_time_array_t<size_t> buckets;		// 0 means empty, everything else is the number of the signature + 1
+
+		constexpr compile_time_signature_table_t(size_t signature_length, size_t max_count) : signature_length(signature_length) {
+			size_t bucket_count = 16;
+			while (bucket_count < max_count * 2) { bucket_count *= 2; }
+			buckets.resize(bucket_count, 0);
+		}
+
+		constexpr size_t intern(const compile_time_array_t<size_t>& signature) {
+			size_t hash = 14695981039346656037ull;
+			for (size_t i = 0; i < signature_length; i++) { hash = (hash ^ signature[i]) * 1099511628211ull; }
+
+			for (size_t bucket = hash & (buckets.size - 1); ; bucket = (bucket + 1) & (buckets.size - 1)) {
+				if (buckets[bucket] == 0) {
+					buckets[bucket] = count + 1;
+					for (size_t i = 0; i < signature_length; i++) { signatures.push_back(signature[i]); }
+					return count++;
+				}
+
+				const size_t number = buckets[bucket] - 1;
+				bool is_equal = true;
+				for (size_t i = 0; i < signature_length && is_equal; i++) { is_equal = signatures[number * signature_length + i] == signature[i]; }
+				if (is_equal) { return number; }
+			}
+		}
+	};
+
+	/*
+	   NOTE: Merges states that can't be told apart: two states are equivalent if every possible input gives the same matches (same match ids,
+	   same order) from both of them. This is Moore's algorithm: start with the states grouped by their output chain, then keep splitting
+	   the groups by which groups their elements lead to, until nothing splits anymore. Every group becomes one state.
+	   The output chains are compared by value, all of them: the first grouping is by match id plus the group of the output link, and
+	   since the output link's group was made the same way, two states only end up in the same group if every id in their chains is the
+	   same, in the same order. That includes the extra states assign_match_ids makes for nodes where more than one string ends, so the
+	   merged states report exactly what the original states reported. Nothing about the behavior changes, the table simply gets shorter.
+	   IMPORTANT: This only does something for specs with character_classes. An Aho-Corasick automaton where every state is one prefix of
+	   the strings is already minimal: the state for a prefix p of string s reports s after the rest of s, and no other state does at that
+	   exact point (that would need p to end with the other state's prefix and the other way around). The only way to get equivalent states
+	   is build_trie branching one element out into several classes, which makes several prefixes with the same match ids. [0-9] and
+	   the like are usually one class, but . is every class there is, so something like "a.c" in a spec with 30 classes has 30 nodes after
+	   the a, and most of them (the ones that don't happen to also be the beginning of another string) end up being one state again.
+	   That's why build_automaton only calls this when the spec has the character_classes flag, it would just waste compile time otherwise.
+	   breadth_first_order is every state except the root, in an order where every output link target comes before the states that
+	   link to it (breadth-first, with the extra states of a node right before the node, see build_automaton).
+	*/
+	constexpr void minimize_automaton(size_t class_count, size_t no_match_id, const compile_time_array_t<size_t>& breadth_first_order,
+					  compile_time_array_t<size_t>& transitions, compile_time_array_t<size_t>& match_ids, compile_time_array_t<size_t>& output_links) {
+		const size_t state_count = match_ids.size;
+
+		compile_time_array_t<size_t> groups;
+		groups.resize(state_count, 0);
+		compile_time_array_t<size_t> signature;
+		signature.resize(class_count + 1, 0);
+
+		// NOTE: The root goes first, so the root's group is 0, and it stays 0 in every round (see below), and it's always alone in there.
+		size_t group_count;
+		{
+			compile_time_signature_table_t chain_table(2, state_count);
+			signature[0] = no_match_id;
+			signature[1] = 0;
+			chain_table.intern(signature);
+			for (size_t i = 0; i < breadth_first_order.size; i++) {
+				const size_t state = breadth_first_order[i];
+				if (match_ids[state] == no_match_id) { continue; }	// NOTE: Group 0, same as the root, for now.
+				signature[0] = match_ids[state];
+				signature[1] = groups[output_links[state]];
+				groups[state] = chain_table.intern(signature);
+			}
+			group_count = chain_table.count;
+		}
+
+		compile_time_array_t<size_t> new_groups;
+		new_groups.resize(state_count, 0);
+		while (true) {
+			compile_time_signature_table_t group_table(class_count + 1, state_count);
+			for (size_t state = 0; state < state_count; state++) {
+				signature[0] = groups[state];
+				for (size_t byte_class = 0; byte_class < class_count; byte_class++) {
+					signature[byte_class + 1] = groups[transitions[state * class_count + byte_class]];
+				}
+				new_groups[state] = group_table.intern(signature);
+			}
+			groups.swap(new_groups);
+			// NOTE: Groups only ever split, so if the count stays the same, nothing changed.
+			if (group_count == group_table.count) { break; }
+			group_count = group_table.count;
+		}
+
+		compile_time_array_t<size_t> group_transitions;
+		compile_time_array_t<size_t> group_match_ids;
+		compile_time_array_t<size_t> group_output_links;
+		group_transitions.resize(group_count * class_count, 0);
+		group_match_ids.resize(group_count, no_match_id);
+		group_output_links.resize(group_count, 0);
+		// NOTE: Every state in a group is as good as any other, so the last one simply wins.
+		for (size_t state = 0; state < state_count; state++) {
+			const size_t group = groups[state];
+			for (size_t byte_class = 0; byte_class < class_count; byte_class++) {
+				group_transitions[group * class_count + byte_class] = groups[transitions[state * class_count + byte_class]];
+			}
+			group_match_ids[group] = match_ids[state];
+			group_output_links[group] = groups[output_links[state]];
+		}
+
+		transitions.swap(group_transitions);
+		match_ids.swap(group_match_ids);
+		output_links.swap(group_output_links);
+	}
+
+	/*
+	   NOTE: Builds the whole automaton in compile-time memory, in two passes (three with minimize_automaton). The first pass builds a plain
+	   trie over the byte classes (see build_trie), with one row per trie node, and decides where the match ids go (see assign_match_ids,
+	   which adds an extra state for every string that ends in a node where another one ends already). The second pass is the
+	   Aho-Corasick part: it walks the trie breadth-first, works out the failure link for every node and folds it into the transitions,
+	   so that every element points to the correct next state, even the ones where none of the strings continue to match. That's what
+	   gets rid of the skipped spots in the input stream that the old version of this table had (see the README).
+	   What comes out is already in the form the table wants (see string_matcher_table_t): transitions has class_count elements per
+	   state (state indices, not row offsets), match_ids has the id of the longest string that ends in a state (the first one in the spec if
+	   there's more than one, no_match_id if none does),
+	   and output_links has the next state in the output chain (0 if there isn't one). The states aren't renumbered yet,
+	   compile_to_table does that. Returns the number of strings, empty ones included.
+	*/
+	constexpr size_t build_automaton(const const_string& meta_matcher_spec, const unsigned char (&byte_classes)[string_matcher_character_count], size_t class_count,
+					 size_t no_match_id, compile_time_array_t<size_t>& transitions, compile_time_array_t<size_t>& match_ids,
+					 compile_time_array_t<size_t>& output_links) {
+		compile_time_array_t<size_t> string_end_rows;
+		compile_time_array_t<size_t> string_end_row_begins;
+		const size_t string_count = build_trie(meta_matcher_spec, byte_classes, class_count, transitions, string_end_rows, string_end_row_begins);
+		const size_t node_count = transitions.size / class_count;
+
+		compile_time_array_t<size_t> own_match_ids;	// see assign_match_ids for these three
+		compile_time_array_t<size_t> own_chain_links;
+		compile_time_array_t<size_t> chain_owners;
+		assign_match_ids(string_count, node_count, no_match_id, string_end_rows, string_end_row_begins, own_match_ids, own_chain_links, chain_owners);
+		const size_t state_count = own_match_ids.size;
+		transitions.resize(state_count * class_count, 0);
+
+		compile_time_array_t<size_t> failure_links;
+		compile_time_array_t<size_t> own_output_links;	// closest node along the failure chain that has an own match id (0 if none)
+		failure_links.resize(node_count, 0);
+		own_output_links.resize(node_count, 0);
+
+		// NOTE: Breadth-first order is important here. The failure link of a node always points to a node that's higher up in the trie,
+		// so when we get to a node, the row of it's failure link is already completely folded and we can simply copy from it.
+		// The root row doesn't need any folding, an element that's 0 already sends the interpreter back to the root.
+		// NOTE: The queue ends up containing every node except the root in breadth-first order.
+		compile_time_array_t<size_t> queue;
+		size_t queue_front = 0;
+
+		for (size_t byte_class = 0; byte_class < class_count; byte_class++) {
+			const size_t child = transitions[byte_class];
+			if (child != 0) { queue.push_back(child); }	// NOTE: failure_links and own_output_links are already 0 for these.
+		}
+
+		while (queue_front != queue.size) {
+			const size_t row = queue[queue_front++];
+			const size_t failure_row = failure_links[row];
+
+			for (size_t byte_class = 0; byte_class < class_count; byte_class++) {
+				const size_t folded_next_state = transitions[failure_row * class_count + byte_class];
+				const size_t child = transitions[row * class_count + byte_class];
+
+				if (child == 0) {
+					transitions[row * class_count + byte_class] = folded_next_state;
+					continue;
+				}
+
+				failure_links[child] = folded_next_state;
+				own_output_links[child] = own_match_ids[folded_next_state] != no_match_id ? folded_next_state : own_output_links[folded_next_state];
+				queue.push_back(child);
+			}
+		}
+
+		for (size_t extra_state = node_count; extra_state < state_count; extra_state++) {
+			for (size_t byte_class = 0; byte_class < class_count; byte_class++) {
+				transitions[extra_state * class_count + byte_class] = transitions[chain_owners[extra_state] * class_count + byte_class];
+			}
+		}
+
+		// NOTE: A state that has own match ids reports them first (it's own chain), then the chain of it's own output link.
+		// A state without one simply has the same chain as the closest node along it's failure chain that does. So following output_links
+		// from any accepting state only ever lands on states where match_ids is the state's own string. That's what lets the interpreter
+		// simply walk the chain until it hits 0.
+		match_ids.resize(state_count, no_match_id);
+		output_links.resize(state_count, 0);
+		for (size_t state = 1; state < state_count; state++) {
+			if (own_match_ids[state] == no_match_id) { continue; }
+			match_ids[state] = own_match_ids[state];
+			output_links[state] = own_chain_links[state] != 0 ? own_chain_links[state] : own_output_links[state < node_count ? state : chain_owners[state]];
+		}
+		for (size_t row = 1; row < node_count; row++) {
+			if (own_match_ids[row] != no_match_id || own_output_links[row] == 0) { continue; }
+			match_ids[row] = match_ids[own_output_links[row]];
+			output_links[row] = output_links[own_output_links[row]];
+		}
+
+		if (meta_matcher_spec.has_flag(character_classes)) {
+			// NOTE: minimize_automaton wants every output link target before the states that link to it, so the extra states of a node
+			// go right before the node, last one first. The targets of the last ones are shorter prefixes, so those are in there already.
+			compile_time_array_t<size_t> breadth_first_order;
+			compile_time_array_t<size_t> own_chain;
+			for (size_t i = 0; i < queue.size; i++) {
+				own_chain.clear();
+				for (size_t state = own_chain_links[queue[i]]; state != 0; state = own_chain_links[state]) { own_chain.push_back(state); }
+				for (size_t j = own_chain.size; j != 0; j--) { breadth_first_order.push_back(own_chain[j - 1]); }
+				breadth_first_order.push_back(queue[i]);
+			}
+			minimize_automaton(class_count, no_match_id, breadth_first_order, transitions, match_ids, output_links);
+		}
+
+		return string_count;
+	}
+
+	/*
+	   NOTE: The table's length has to be a template argument, so the automaton has to be built in one constant expression and the table
+	   created in another one, and compile-time memory (compile_time_array_t) can't survive from one to the other. So the automaton gets
+	   built exactly once, into one of these, which is a plain literal type with room for state_capacity states, and the table is created
+	   from that (see create_string_matcher_table). Only the first state_count states are used.
+	*/
+	template <size_t template_state_capacity, size_t template_class_count>
+	struct built_automaton_t {
+		static constexpr size_t state_capacity = template_state_capacity;
+		static constexpr size_t class_count = template_class_count;
+
+		size_t state_count;
+		size_t string_count;
+		size_t transitions[state_capacity * class_count];
+		size_t match_ids[state_capacity];
+		size_t output_links[state_capacity];
+	};
+
+	/*
+	   NOTE: The number of states build_automaton has before minimize_automaton gets to them (one for the root, one for every node of the trie
+	   and one for every extra state assign_match_ids makes), for the size of built_automaton_t. That's exactly the number of states for
+	   specs without character_classes, nothing gets merged there. For the others, it's more than build_automaton ends up with, and there's
+	   no way around that: how many states minimize_automaton merges is only known after running it, on the whole automaton. It's only the
+	   trie, no failure links and no minimizing, so it's cheap compared to the real thing, and the table itself still gets the exact number
+	   (see create_string_matcher_table), only the automaton in between is a bit bigger than it has to be.
+	   This used to be done without building anything, by adding up the string lengths minus the longest common prefix with any earlier
+	   string, but that doesn't work anymore now that elements can match more than one class (see build_trie).
+	*/
+	constexpr size_t calculate_state_capacity(const const_string& meta_matcher_spec) {
+		unsigned char byte_classes[string_matcher_character_count];
+		const size_t class_count = calculate_byte_classes(meta_matcher_spec, byte_classes);
+
+		compile_time_array_t<size_t> children;
+		compile_time_array_t<size_t> string_end_rows;
+		compile_time_array_t<size_t> string_end_row_begins;
+		const size_t string_count = build_trie(meta_matcher_spec, byte_classes, class_count, children, string_end_rows, string_end_row_begins);
+
+		compile_time_array_t<size_t> own_match_ids;
+		compile_time_array_t<size_t> own_chain_links;
+		compile_time_array_t<size_t> chain_owners;
+		assign_match_ids(string_count, children.size / class_count, string_count, string_end_rows, string_end_row_begins,
+				 own_match_ids, own_chain_links, chain_owners);
+		return own_match_ids.size;
+	}
+
+	template <size_t state_capacity, size_t class_count, size_t match_count>
+	consteval built_automaton_t<state_capacity, class_count> build_automaton_for_table(const const_string& meta_matcher_spec) {
+		unsigned char byte_classes[string_matcher_character_count];
+		calculate_byte_classes(meta_matcher_spec, byte_classes);
+
+		// NOTE: no_match_id is match_count, same as in compile_to_table.
+		compile_time_array_t<size_t> transitions;
+		compile_time_array_t<size_t> match_ids;
+		compile_time_array_t<size_t> output_links;
+		built_automaton_t<state_capacity, class_count> result { };
+		result.string_count = build_automaton(meta_matcher_spec, byte_classes, class_count, match_count, transitions, match_ids, output_links);
+		result.state_count = match_ids.size;
+		// NOTE: Minimizing only ever merges states, so if this happens, calculate_state_capacity and build_automaton disagree about the trie.
+		if (result.state_count > state_capacity) { static_fail_with_msg("internal error, build_automaton made more states than calculate_state_capacity counted"); }
+
+		for (size_t i = 0; i < transitions.size; i++) { result.transitions[i] = transitions[i]; }
+		for (size_t state = 0; state < result.state_count; state++) {
+			result.match_ids[state] = match_ids[state];
+			result.output_links[state] = output_links[state];
+		}
+		return result;
+	}
+
+	// NOTE: Empty structs/classes are well defined in the C++ spec (although being UB in the C spec).
+	// The following line is totally valid, there is one thing you have to watch out for though: sizeof(zero_out_t) is never equal to zero.
+	// It must at minimum be 1, but the implementation can define exactly how big, so it could be 50 or 1000, although that practically
+	// never happens (so don't worry about taking up space, AFAIK it's 1 most of the time).
+	// REASONING: A struct with size 0 could technically be located at the exact same spot as another struct, because it doesn't
+	// take up any memory, and that doesn't make any sense. Think about it this way: what would an array of these structs look like?
+	// The more I think about it, the more I think one could make everything work with 0-sized empty structs, but I guess the
+	// designers chose not to go down that route to avoid causing unnecessary confusion.
+	// TODO: Research more about this.
+	struct zero_out_t { } zero_out;
+
+	// NOTE: The smallest unsigned integer type that can hold max_value. Used for the elements of the table, so that a table with
+	// less than 256 states only needs one byte per element. The number of states is known at compile-time, so this costs nothing.
+	template <size_t max_value>
+	using smallest_unsigned_integer_t = std::conditional_t<max_value <= UINT8_MAX, uint8_t,
+					    std::conditional_t<max_value <= UINT16_MAX, uint16_t,
+					    std::conditional_t<max_value <= UINT32_MAX, uint32_t, uint64_t>>>;
+
+	// NOTE: One match, for when you want the matches as data instead of as callbacks (see find_matches). begin and end are input stream
+	// positions and end is one past the last character, so end - begin is the length of the string. Unlike the callbacks, you get
+	// where the match begins too.
+	struct string_match_t {
+		size_t match_id;
+		size_t begin;
+		size_t end;
+	};
+
+	// NOTE: How many first bytes the prefilter can look for at most, see basic_string_matcher_table_t.
+	inline constexpr size_t string_matcher_prefilter_max_first_byte_count = 8;
+
+	/*
+	   NOTE: The stats policy of string_matcher_t. This one is the default, it doesn't count anything and all of it's functions are empty,
+	   so after inlining, the interpreter loop is exactly the same as without it. It takes up no space in the matcher either ([[no_unique_address]]).
+	   The table's interpreter calls these (it's the observer parameter of scan and match_character):
+	   count_transition(state, next_state) for every character it looks at (both row offsets),
+	   count_skipped_characters(count) when the prefilter skips characters without looking at them, and the matcher calls
+	   count_match(match_id) for every match it reports.
+	*/
+	struct string_matcher_no_stats_t {
+		static constexpr bool is_enabled = false;
+
+		constexpr void count_transition(size_t, size_t) const noexcept { }
+		constexpr void count_skipped_characters(size_t) const noexcept { }
+		constexpr void count_match(size_t) const noexcept { }
+	};
+
+	/*
+	   NOTE: The stats policy that actually counts, for when you want to see what a matcher does with your real input: which states are hot
+	   (state_visit_counts, indexed by state index), how often it falls all the way back to the root from somewhere else (root_reset_count,
+	   every time that happens, everything it was in the middle of matching turned out not to match), how much the prefilter skipped and how
+	   often each string matched (match_counts, indexed by match id). character_count counts everything that went through the matcher,
+	   skipped characters included, so character_count - skipped_character_count is the sum of state_visit_counts.
+	   IMPORTANT: This is one more load and store per character (and a compare for the root resets), so it's for finding out how your
+	   spec behaves, not for production. The counters are plain uint64_t's in the matcher itself, they aren't atomic, so every matcher
+	   counts it's own stream and you add them up yourself if you want totals.
+	   There's no pending longest match or anything like that to count, every match gets reported as soon as it's last character comes in.
+	*/
+	template <typename table_t>
+	struct string_matcher_stats_t {
+		static constexpr bool is_enabled = true;
+
+		uint64_t character_count = 0;
+		uint64_t skipped_character_count = 0;
+		uint64_t root_reset_count = 0;
+		uint64_t state_visit_counts[table_t::length] { };
+		uint64_t match_counts[table_t::match_count] { };
+
+		constexpr void count_transition(size_t state, size_t next_state) noexcept {
+			character_count++;
+			state_visit_counts[next_state / table_t::class_count]++;
+			root_reset_count += state != 0 && next_state == 0;
+		}
+
+		constexpr void count_skipped_characters(size_t count) noexcept {
+			character_count += count;
+			skipped_character_count += count;
+		}
+
+		constexpr void count_match(size_t match_id) noexcept { match_counts[match_id]++; }
+	};
+
+	/*
+	   NOTE: This table used to be made of elements that each had a next state pointer and a callback pointer, 16 bytes per element,
+	   and almost all of them were null. Now, an element is simply the offset of the next state's row (state index times class_count),
+	   in the smallest type that fits, so 1 to 4 bytes. Using the row offset instead of the state index means the interpreter
+	   only has to add the byte class to it to get the next element, no multiplication. That's also why data is a 1D array.
+	   Because of all that, there aren't any pointers in here anymore, which means the whole thing can be built at compile-time and
+	   put straight into a constexpr variable, which lands in .rodata (where it can be shared between processes that map the same binary),
+	   and there's no code that has to run at startup. The fixup lambda that CREATE_META_STRING_MATCHER used to need is gone.
+	   The callbacks aren't in here either, they're in their own little array, indexed by match id. The match id of a string is simply it's
+	   position in the matcher spec, so it's the same index as it's callback in the list of callbacks you give the macro.
+	   IMPORTANT: Keeping the callbacks separate is important for the .rodata thing. Function pointers need relocations when the binary is
+	   position independent, so an object that contains even one of them ends up in .data.rel.ro instead, which gets written to at load time
+	   and isn't shared anymore.
+	   The information about which strings end in which state is stored per state instead of per element, see below.
+	*/
+	template <size_t template_length, size_t template_class_count, size_t template_match_count, size_t template_longest_match_length>
+	class string_matcher_table_storage_t {
+	public:
+		static constexpr size_t length = template_length;
+		static constexpr size_t class_count = template_class_count;
+		static constexpr size_t match_count = template_match_count;
+		// NOTE: The length of the longest string in the spec. Nothing that happened more than this many characters ago can have any
+		// influence on the current state, which is useful when you want to start scanning somewhere in the middle of a stream.
+		static constexpr size_t longest_match_length = template_longest_match_length;
+
+		using state_t = smallest_unsigned_integer_t<(length - 1) * class_count>;
+		using match_id_t = smallest_unsigned_integer_t<match_count - 1>;
+
+		unsigned char byte_classes[string_matcher_character_count];
+		state_t data[length * class_count];
+
+		/*
+		   NOTE: compile_to_table numbers the states so that every state in which at least one string ends comes after all the states in which
+		   nothing ends. That way, the interpreter only has to compare the state with first_accepting_state to know if there's a match,
+		   it doesn't have to load anything. The root is always state 0, and nothing can ever end in the root (empty strings are skipped),
+		   so first_accepting_state is never 0. Like the elements, it's a row offset.
+		   For every accepting state, match_ids has the id of the longest string that ends in it, and output_links has the next
+		   accepting state in the output chain (the state for the next shorter string that also ends there), or 0 if there isn't one.
+		   For the other states, both are 0 and never looked at. These two are indexed by state index, not row offset, but the division
+		   is by a compile-time constant, so it's cheap, and it only happens when something matched anyway.
+		*/
+		size_t first_accepting_state;
+		match_id_t match_ids[length];
+		state_t output_links[length];
+
+		// NOTE: The length of every string (in bytes, empty ones are 0), indexed by match id. With that, we know where a match begins.
+		using match_length_t = smallest_unsigned_integer_t<longest_match_length>;
+		match_length_t match_lengths[match_count];
+		// NOTE: The longest output chain in the table, so the most matches that can ever end at one character. find_matches needs this.
+		size_t max_matches_per_character;
+
+		// NOTE: For the prefilter, see basic_string_matcher_table_t.
+		size_t first_byte_count;
+		unsigned char first_bytes[string_matcher_prefilter_max_first_byte_count];
+
+		// NOTE: See compile_to_table for why this constructor exists.
+		constexpr string_matcher_table_storage_t(zero_out_t zero_out_flag) :
+			byte_classes { }, data { }, first_accepting_state(length * class_count), match_ids { }, output_links { }, match_lengths { }, max_matches_per_character(0),
+			first_byte_count(0), first_bytes { }
+		{ }
+	};
+
+	/*
+	   NOTE: The interpreter half of the table. It's the same code for every kind of table there is, storage_t only decides where the numbers
+	   live: string_matcher_table_storage_t has them all in arrays whose sizes are compile-time constants (that's the table
+	   CREATE_META_STRING_MATCHER makes), runtime_string_matcher_table_storage_t (see meta_string_match_runtime.h) has them behind pointers,
+	   with the sizes in normal member variables. The names are the same either way, so none of the code below has to care.
+	*/
+	template <typename storage_t>
+	class basic_string_matcher_table_t : public storage_t {
+	public:
+		using storage_t::storage_t;
+
+		using storage_t::length;
+		using storage_t::class_count;
+		using storage_t::match_count;
+		using storage_t::longest_match_length;
+		using typename storage_t::state_t;
+		using typename storage_t::match_id_t;
+		using typename storage_t::match_length_t;
+		using storage_t::byte_classes;
+		using storage_t::data;
+		using storage_t::first_accepting_state;
+		using storage_t::match_ids;
+		using storage_t::output_links;
+		using storage_t::match_lengths;
+		using storage_t::max_matches_per_character;
+		using storage_t::first_byte_count;
+		using storage_t::first_bytes;
+
+		/*
+		   NOTE: Most of the time, the interpreter sits in the root, and most characters simply keep it there. Only the characters that start
+		   one of the strings (first_bytes) can get it out, so while it's in the root, scan looks for the next one of those with SIMD (16 or 32
+		   characters at a time) and skips everything in between without touching the table. Nothing can match in the root, so skipping
+		   is safe. Every first byte costs one extra compare per block, so the prefilter is only used when there are at most
+		   prefilter_max_first_byte_count of them, otherwise it wouldn't skip much anyway and the plain table lookup is just as fast.
+		   first_byte_count is the real count, even if it's bigger than that, in which case first_bytes is incomplete and not used.
+		*/
+		static constexpr size_t prefilter_max_first_byte_count = string_matcher_prefilter_max_first_byte_count;
+		static constexpr size_t prefilter_min_skip_length = 16;
+		static constexpr size_t prefilter_backoff_length = 64;
+
+		constexpr bool is_first_byte(char character) const noexcept { return data[byte_classes[(unsigned char)character]] != 0; }
+
+		bool has_prefilter() const noexcept { return first_byte_count <= prefilter_max_first_byte_count; }
+
+		// NOTE: Returns a pointer to the first character in [begin, end) that can get the interpreter out of the root, or end if there isn't one.
+		// IMPORTANT: Only works if has_prefilter() is true.
+		const char* find_first_byte(const char* begin, const char* end) const noexcept {
+			const char* character_ptr = begin;
+			// NOTE: After a failed match, the interpreter is often back in the root right before the next candidate,
+			// so check the first character the cheap way before setting up the vectors.
+			if (character_ptr == end || is_first_byte(*character_ptr)) { return character_ptr; }
+			character_ptr++;
+
+#if defined(__AVX2__)
+			__m256i wide_needles[prefilter_max_first_byte_count];
+			for (size_t i = 0; i < first_byte_count; i++) { wide_needles[i] = _mm256_set1_epi8((char)first_bytes[i]); }
+			for (; end - character_ptr >= 32; character_ptr += 32) {
+				const __m256i block = _mm256_loadu_si256((const __m256i*)character_ptr);
+				__m256i hits = _mm256_cmpeq_epi8(block, wide_needles[0]);
+				for (size_t i = 1; i < first_byte_count; i++) { hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, wide_needles[i])); }
+				const uint32_t hit_mask = _mm256_movemask_epi8(hits);
+				if (hit_mask != 0) { return character_ptr + __builtin_ctz(hit_mask); }
+			}
+#endif
+#if defined(__SSE2__)
+			__m128i needles[prefilter_max_first_byte_count];
+			for (size_t i = 0; i < first_byte_count; i++) { needles[i] = _mm_set1_epi8((char)first_bytes[i]); }
+			for (; end - character_ptr >= 16; character_ptr += 16) {
+				const __m128i block = _mm_loadu_si128((const __m128i*)character_ptr);
+				__m128i hits = _mm_cmpeq_epi8(block, needles[0]);
+				for (size_t i = 1; i < first_byte_count; i++) { hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[i])); }
+				const uint32_t hit_mask = _mm_movemask_epi8(hits);
+				if (hit_mask != 0) { return character_ptr + __builtin_ctz(hit_mask); }
+			}
+#endif
+			// NOTE: The scalar fallback (and the tail of the SIMD versions). Not faster than the interpreter loop by itself, but
+			// it doesn't have to carry the state and the input stream position around.
+			for (; character_ptr != end; character_ptr++) {
+				if (is_first_byte(*character_ptr)) { return character_ptr; }
+			}
+			return end;
+		}
+
+		constexpr size_t next_state(size_t state, char character) const noexcept { return data[state + byte_classes[(unsigned char)character]]; }
+
+		constexpr bool is_accepting(size_t state) const noexcept { return state >= first_accepting_state; }
+
+		// NOTE: For checking states that come from outside, see string_matcher_stream_state_t.
+		constexpr bool is_valid_state(size_t state) const noexcept { return state < length * class_count && state % class_count == 0; }
+
+		// NOTE: Calls match_handler with the match id of every string that ends in accepting_state, longest first,
+		// and returns how many there were.
+		template <typename match_handler_t>
+		constexpr size_t for_each_match(size_t accepting_state, match_handler_t&& match_handler) const noexcept {
+			size_t match_count = 0;
+			for (size_t output_state = accepting_state; output_state != 0; output_state = output_links[output_state / class_count]) {
+				match_handler((size_t)match_ids[output_state / class_count]);
+				match_count++;
+			}
+			return match_count;
+		}
+
+		constexpr string_match_t make_match(size_t match_id, size_t position) const noexcept {
+			return { match_id, position + 1 - match_lengths[match_id], position + 1 };
+		}
+
+		static constexpr size_t no_match_id = (size_t)-1;
+
+		/*
+		   NOTE: Tells you which string the whole token is, or no_match_id if it isn't any of them. This is for the cases where you don't want
+		   to find strings somewhere in a stream, but want to know which of your strings you've got in your hands (command line arguments,
+		   keywords in a tokenizer, header names and such). It simply runs the token through the table from the root. The state at the end
+		   knows the longest string that ends at the last character, and if that string is exactly as long as the token, it started at the
+		   first character, so it's the whole token. Tokens that are longer than the longest string can't be anything, so those are rejected
+		   without looking at them. It's constexpr, so it works at compile-time too.
+		*/
+		constexpr size_t lookup(std::string_view token) const noexcept {
+			if (token.size() == 0 || token.size() > longest_match_length) { return no_match_id; }
+
+			size_t state = 0;
+			for (const char character : token) { state = next_state(state, character); }
+
+			if (!is_accepting(state)) { return no_match_id; }
+			const size_t match_id = match_ids[state / class_count];
+			return match_lengths[match_id] == token.size() ? match_id : no_match_id;
+		}
+
+		// NOTE: One step of the interpreter, for match_character. Same deal as scan below.
+		template <typename match_handler_t, typename observer_t = string_matcher_no_stats_t>
+		constexpr bool match_character(size_t& state, size_t& input_stream_position, char character, match_handler_t&& match_handler,
+					       observer_t&& observer = observer_t()) const noexcept {
+			const size_t new_state = next_state(state, character);
+			observer.count_transition(state, new_state);
+			state = new_state;
+			const size_t position = input_stream_position++;
+			if (!is_accepting(state)) { return false; }
+			for_each_match(state, [&](size_t match_id) { match_handler(match_id, position); });
+			return true;
+		}
+
+		// NOTE: This is the interpreter loop. The state and the input stream position are passed in by reference so that the caller can
+		// keep them wherever it wants, they're copied into local variables for the whole buffer and only get written back at the end.
+		// match_handler gets called with the match id and the input stream position of every match.
+		// Returns the number of matches.
+		// NOTE: Uses the prefilter (see above) whenever the interpreter is in the root, if the table has one.
+		// observer is the stats policy of the matcher (see string_matcher_no_stats_t), the default one compiles down to nothing.
+		template <typename match_handler_t, typename observer_t = string_matcher_no_stats_t>
+		constexpr size_t scan(size_t& state, size_t& input_stream_position, const char* begin, const char* end, match_handler_t&& match_handler,
+				      observer_t&& observer = observer_t()) const noexcept {
+			if (std::is_constant_evaluated() || !has_prefilter()) { return scan_without_prefilter(state, input_stream_position, begin, end, match_handler, observer); }
+
+			size_t local_state = state;
+			size_t local_input_stream_position = input_stream_position;
+			size_t match_count = 0;
+
+			// NOTE: When the first bytes are common in the input, the interpreter keeps landing back in the root right in front of the next
+			// candidate, and searching every time costs way more than it saves (mostly because checking for the root on every character
+			// is a branch that can't be predicted). So when a search doesn't skip much, we stop looking at the prefilter for the next
+			// prefilter_backoff_length characters and run the plain loop over them, which is exactly as fast as scan_without_prefilter.
+			size_t stretch_length = 1;
+
+			for (const char* character_ptr = begin; character_ptr != end; ) {
+				if (local_state == 0) {
+					const char* candidate_ptr = find_first_byte(character_ptr, end);
+					stretch_length = (size_t)(candidate_ptr - character_ptr) < prefilter_min_skip_length ? prefilter_backoff_length : 1;
+					observer.count_skipped_characters(candidate_ptr - character_ptr);
+					local_input_stream_position += candidate_ptr - character_ptr;
+					character_ptr = candidate_ptr;
+				}
+
+				const char* stretch_end = (size_t)(end - character_ptr) > stretch_length ? character_ptr + stretch_length : end;
+				for (; character_ptr != stretch_end; character_ptr++, local_input_stream_position++) {
+					const size_t new_state = next_state(local_state, *character_ptr);
+					observer.count_transition(local_state, new_state);
+					local_state = new_state;
+					if (!is_accepting(local_state)) { continue; }
+					match_count += for_each_match(local_state, [&](size_t match_id) { match_handler(match_id, local_input_stream_position); });
+				}
+			}
+
+			state = local_state;
+			input_stream_position = local_input_stream_position;
+			return match_count;
+		}
+
+		/*
+		   NOTE: Same as scan, except that instead of calling anything, it writes the matches into the matches buffer, max_match_count at most,
+		   and stops when the buffer could fill up. begin is moved to where it stopped, so you call it again with the same begin (after
+		   you've done whatever you want with the matches) until begin is end. Returns how many matches it wrote.
+		   The trick is that one character can't produce more than max_matches_per_character matches, so a block of
+		   (free space / max_matches_per_character) characters can never overflow the buffer. The blocks are simply scanned with scan and a
+		   handler that writes into the buffer, which gets inlined, so there's no check on every character and no indirect call on every match.
+		   The prefilter still works too. When there are only a few matches, the blocks stay huge, so there's hardly any overhead.
+		   IMPORTANT: max_match_count has to be at least max_matches_per_character, or it can't ever get past a character. It returns 0
+		   without moving begin in that case.
+		*/
+		constexpr size_t find_matches(size_t& state, size_t& input_stream_position, const char*& begin, const char* end,
+					      string_match_t* matches, size_t max_match_count) const noexcept {
+			return find_matches_blockwise(begin, end, matches, max_match_count, [&](const char* block_begin, const char* block_end, auto&& match_handler) {
+				return scan(state, input_stream_position, block_begin, block_end, match_handler);
+			});
+		}
+
+		// NOTE: The block logic of find_matches, on it's own so that string_matcher_switch_t can use it with it's own interpreter.
+		template <typename block_scanner_t>
+		constexpr size_t find_matches_blockwise(const char*& begin, const char* end, string_match_t* matches, size_t max_match_count,
+							block_scanner_t&& scan_block) const noexcept {
+			size_t match_count = 0;
+			while (begin != end) {
+				const size_t block_length = (max_match_count - match_count) / max_matches_per_character;
+				if (block_length == 0) { break; }
+				const char* block_end = (size_t)(end - begin) > block_length ? begin + block_length : end;
+				scan_block(begin, block_end, [&](size_t match_id, size_t position) { matches[match_count++] = make_match(match_id, position); });
+				begin = block_end;
+			}
+			return match_count;
+		}
+
+		template <typename match_handler_t, typename observer_t = string_matcher_no_stats_t>
+		constexpr size_t scan_without_prefilter(size_t& state, size_t& input_stream_position, const char* begin, const char* end,
+							match_handler_t&& match_handler, observer_t&& observer = observer_t()) const noexcept {
+			size_t local_state = state;
+			size_t local_input_stream_position = input_stream_position;
+			size_t match_count = 0;
+
+			for (const char* character_ptr = begin; character_ptr != end; character_ptr++, local_input_stream_position++) {
+				const size_t new_state = next_state(local_state, *character_ptr);
+				observer.count_transition(local_state, new_state);
+				local_state = new_state;
+				if (!is_accepting(local_state)) { continue; }
+				match_count += for_each_match(local_state, [&](size_t match_id) { match_handler(match_id, local_input_stream_position); });
+			}
+
+			state = local_state;
+			input_stream_position = local_input_stream_position;
+			return match_count;
+		}
+
+		/*
+		   NOTE: scan is one long chain of dependent loads: the interpreter can't look up the next element before it has the current one,
+		   so the core spends most of it's time waiting for the cache, no matter how fast it is. This scans stream_count independent streams
+		   (different connections, different files, whatever) at the same time, one character from each stream per step. The lookups of the
+		   different streams don't depend on each other, so the core can have all of them in flight at once. stream_count is a template
+		   parameter so that the inner loop gets unrolled completely and all the states stay in registers. 4 to 8 is usually the sweet spot,
+		   more than that runs out of registers.
+		   match_handler gets called with the stream index, the match id and the input stream position (of that stream) of every match.
+		   The matches of one stream come in order, but the matches of different streams are interleaved.
+		   The buffers don't have to be the same length. Once the shortest one is done, the rest of each stream is finished with scan.
+		   Returns the number of matches in all streams together.
+		*/
+		template <size_t stream_count, typename match_handler_t>
+		constexpr size_t scan_interleaved(size_t (&states)[stream_count], size_t (&input_stream_positions)[stream_count],
+						  const std::span<const char> (&buffers)[stream_count], match_handler_t&& match_handler) const noexcept {
+			static_assert(stream_count != 0, "scan_interleaved needs at least one stream");
+
+			size_t common_length = buffers[0].size();
+			for (size_t stream_index = 1; stream_index < stream_count; stream_index++) {
+				if (buffers[stream_index].size() < common_length) { common_length = buffers[stream_index].size(); }
+			}
+
+			size_t local_states[stream_count];
+			for (size_t stream_index = 0; stream_index < stream_count; stream_index++) { local_states[stream_index] = states[stream_index]; }
+			size_t match_count = 0;
+
+			for (size_t i = 0; i < common_length; i++) {
+				for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+					local_states[stream_index] = next_state(local_states[stream_index], buffers[stream_index][i]);
+				}
+				for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+					if (!is_accepting(local_states[stream_index])) { continue; }
+					const size_t position = input_stream_positions[stream_index] + i;
+					match_count += for_each_match(local_states[stream_index], [&](size_t match_id) { match_handler(stream_index, match_id, position); });
+				}
+			}
+
+			for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+				states[stream_index] = local_states[stream_index];
+				input_stream_positions[stream_index] += common_length;
+				match_count += scan(states[stream_index], input_stream_positions[stream_index],
+						    buffers[stream_index].data() + common_length, buffers[stream_index].data() + buffers[stream_index].size(),
+						    [&](size_t match_id, size_t position) { match_handler(stream_index, match_id, position); });
+			}
+			return match_count;
+		}
+	};
+
+	template <size_t length, size_t class_count, size_t match_count, size_t longest_match_length>
+	using string_matcher_table_t = basic_string_matcher_table_t<string_matcher_table_storage_t<length, class_count, match_count, longest_match_length>>;
+
+	/*
+	   NOTE: Everything a stream has to carry from one chunk to the next, which is only the state of the interpreter and the input stream
+	   position. Nothing is ever pending (every match gets reported as soon as it's last character comes in), so there's no last match
+	   or anything like that to remember. It's 16 bytes, has fixed size types and no pointers, so you can memcpy it wherever you want,
+	   send it to another worker and resume the stream there with restore_stream_state.
+	   IMPORTANT: state is a row offset in the table it came from, so it only means something to matchers that use the same table
+	   (same spec, same build of the program). restore_stream_state checks that it's at least a valid state for the table and refuses it
+	   if it isn't, but it can't know if it's from the same table.
+	*/
+	struct string_matcher_stream_state_t {
+		uint64_t state;
+		uint64_t input_stream_position;
+	};
+
+	/*
+	   NOTE: A cursor is the mutable half of a string matcher: the state of the interpreter and the input stream position, plus pointers to the
+	   table and the callbacks it's using. The table and the callbacks are never written to after compile-time, so any number of cursors
+	   on any number of threads can share them without any synchronization. Give every thread (or every stream) it's own cursor and
+	   you're good. The callbacks themselves have to be thread-safe of course, if the cursors on different threads share them.
+	   The difference to string_matcher_t (see below) is that string_matcher_t knows where the table is at compile-time, while a cursor
+	   only knows at runtime, which means you can decide which table to use at runtime, or keep cursors for different tables of
+	   the same type in one array, etc...
+	*/
+	template <typename template_table_t, typename template_callbacks_t>
+	class string_matcher_cursor_t {
+	public:
+		using table_t = template_table_t;
+		using callbacks_t = template_callbacks_t;
+
+		const table_t* table;
+		const callbacks_t* callbacks;
+
+		size_t state = 0;
+
+		size_t input_stream_position = 0;
+
+		constexpr string_matcher_cursor_t(const table_t& table, const callbacks_t& callbacks) noexcept : table(&table), callbacks(&callbacks) { }
+
+		// NOTE: See string_matcher_t for the details of these.
+		bool match_character(char character) noexcept {
+			return table->match_character(state, input_stream_position, character,
+						      [this](size_t match_id, size_t position) { (*callbacks)[match_id](position); });
+		}
+
+		size_t scan(const char* begin, const char* end) noexcept {
+			return table->scan(state, input_stream_position, begin, end,
+					   [this](size_t match_id, size_t position) { (*callbacks)[match_id](position); });
+		}
+
+		size_t scan(std::span<const char> buffer) noexcept { return scan(buffer.data(), buffer.data() + buffer.size()); }
+
+		// NOTE: The cursor doesn't know the table at compile-time, so the size of matches can't be checked at compile-time.
+		// IMPORTANT: If it's smaller than table->max_matches_per_character, this returns 0 and doesn't move begin.
+		size_t find_matches(const char*& begin, const char* end, std::span<string_match_t> matches) noexcept {
+			return table->find_matches(state, input_stream_position, begin, end, matches.data(), matches.size());
+		}
+
+		size_t find_matches(std::span<const char>& buffer, std::span<string_match_t> matches) noexcept {
+			const char* begin = buffer.data();
+			const size_t match_count = find_matches(begin, buffer.data() + buffer.size(), matches);
+			buffer = buffer.subspan(begin - buffer.data());
+			return match_count;
+		}
+
+		// NOTE: See string_matcher_t::scan_interleaved. Every cursor gets it's own callbacks called.
+		// IMPORTANT: All the cursors have to use the same table, the one of the first cursor is the one that's used.
+		template <size_t stream_count>
+		static size_t scan_interleaved(string_matcher_cursor_t* const (&cursors)[stream_count], const std::span<const char> (&buffers)[stream_count]) noexcept {
+			size_t states[stream_count];
+			size_t input_stream_positions[stream_count];
+			for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+				states[stream_index] = cursors[stream_index]->state;
+				input_stream_positions[stream_index] = cursors[stream_index]->input_stream_position;
+			}
+
+			const size_t match_count = cursors[0]->table->scan_interleaved(states, input_stream_positions, buffers,
+				[&cursors](size_t stream_index, size_t match_id, size_t position) { (*cursors[stream_index]->callbacks)[match_id](position); });
+
+			for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+				cursors[stream_index]->state = states[stream_index];
+				cursors[stream_index]->input_stream_position = input_stream_positions[stream_index];
+			}
+			return match_count;
+		}
+
+		// NOTE: See string_matcher_t for the details of these.
+		size_t feed(std::span<const char> chunk) noexcept { return scan(chunk); }
+
+		size_t finish() noexcept { return 0; }
+
+		string_matcher_stream_state_t save_stream_state() const noexcept { return { state, input_stream_position }; }
+
+		size_t lookup(std::string_view token) const noexcept { return table->lookup(token); }
+
+		bool lookup_and_call(std::string_view token) const noexcept {
+			const size_t match_id = table->lookup(token);
+			if (match_id == table_t::no_match_id) { return false; }
+			(*callbacks)[match_id](token.size() - 1);
+			return true;
+		}
+
+		bool restore_stream_state(const string_matcher_stream_state_t& stream_state) noexcept {
+			if (!table->is_valid_state(stream_state.state)) { return false; }
+			state = stream_state.state;
+			input_stream_position = stream_state.input_stream_position;
+			return true;
+		}
+
+		void full_reset() noexcept {
+			state = 0;
+			input_stream_position = 0;
+		}
+	};
+
+	/*
+	   NOTE: This is the thing CREATE_META_STRING_MATCHER creates. The table and the callbacks are constexpr variables that it references through
+	   template parameters, so the compiler knows exactly where they are and doesn't even have to load their address from anywhere.
+	   The only things in the object itself are the state of the interpreter and the input stream position, which are both 0 at the start,
+	   so the object gets constant-initialized as well (you can put constinit in front of it if you want to make sure,
+	   see CREATE_CONSTINIT_META_STRING_MATCHER).
+	   NOTE: That also means that it's basically a cursor (see above) that doesn't need the pointers. If you want to scan on multiple threads
+	   at once, simply give every thread it's own decltype(matcher) variable (default constructed, it starts at the beginning), or
+	   use create_cursor. The table is only there once either way.
+	   NOTE: stats_t is the stats policy, string_matcher_no_stats_t (nothing, for free) by default. Give it string_matcher_stats_t<table_t>
+	   (CREATE_META_STRING_MATCHER_WITH_STATS does that for you) and the matcher counts what it does, see stats_snapshot.
+	*/
+	template <const auto& template_table, const auto& template_callbacks, typename template_stats_t = string_matcher_no_stats_t>
+	class string_matcher_t {
+	public:
+		static constexpr const auto& table = template_table;
+		static constexpr const auto& callbacks = template_callbacks;
+
+		using table_t = std::remove_cvref_t<decltype(template_table)>;
+		using callbacks_t = std::remove_cvref_t<decltype(template_callbacks)>;
+		using cursor_t = string_matcher_cursor_t<table_t, callbacks_t>;
+		using stats_t = template_stats_t;
+
+		size_t state = 0;
+
+		size_t input_stream_position = 0;
+
+		[[no_unique_address]] stats_t stats;
+
+	private:
+		// NOTE: The callbacks, plus counting the match if stats_t wants that.
+		auto match_handler() noexcept {
+			return [this](size_t match_id, size_t position) {
+				stats.count_match(match_id);
+				callbacks[match_id](position);
+			};
+		}
+
+	public:
+		// NOTE: Every string that ends at the current character gets it's callback called, longest first, even if the strings overlap
+		// each other or overlap earlier matches. Nothing is ever skipped, so there's no need to go back in the input stream anymore.
+		bool match_character(char character) noexcept {
+			return table.match_character(state, input_stream_position, character, match_handler(), stats);
+		}
+
+		// NOTE: Does exactly the same thing as calling match_character for every character in the buffer, callbacks and all,
+		// but the state and the input stream position are kept in local variables for the whole buffer and only get written back
+		// at the end. When you call match_character in a loop, the compiler can't keep them in registers because the callbacks
+		// could (as far as it knows) be looking at the string matcher, so it has to store and load them for every single character.
+		// IMPORTANT: This means that the callbacks can't rely on state or input_stream_position while scan is running.
+		// They get the position as their parameter anyway, so that shouldn't be a problem.
+		// Returns the number of callbacks that were called.
+		size_t scan(const char* begin, const char* end) noexcept {
+			return table.scan(state, input_stream_position, begin, end, match_handler(), stats);
+		}
+
+		size_t scan(std::span<const char> buffer) noexcept { return scan(buffer.data(), buffer.data() + buffer.size()); }
+
+		/*
+		   NOTE: If you'd rather handle the matches in your own code (inlined, with whatever context you want) instead of in callbacks,
+		   use this. Instead of calling the callbacks, it fills matches with { match id, begin, end } records and stops when the array could
+		   overflow, moving begin to where it stopped. So you simply loop until begin is end:
+		   	while (begin != end) { size_t match_count = matcher.find_matches(begin, end, matches); ... }
+		   Returns how many matches it wrote. The array has to be at least table.max_matches_per_character long (the most matches that
+		   can end at one character), you get a compile error if it isn't. Mixing it with scan and match_character is fine, it's the same
+		   interpreter state. See string_matcher_table_t::find_matches for how it works.
+		*/
+		template <size_t max_match_count>
+		size_t find_matches(const char*& begin, const char* end, string_match_t (&matches)[max_match_count]) noexcept {
+			static_assert(max_match_count >= table.max_matches_per_character, "match buffer is too small, it has to hold at least max_matches_per_character matches");
+			if constexpr (!stats_t::is_enabled) { return table.find_matches(state, input_stream_position, begin, end, matches, max_match_count); }
+			return table.find_matches_blockwise(begin, end, matches, max_match_count, [this](const char* block_begin, const char* block_end, auto&& block_match_handler) {
+				return table.scan(state, input_stream_position, block_begin, block_end, [&](size_t match_id, size_t position) {
+					stats.count_match(match_id);
+					block_match_handler(match_id, position);
+				}, stats);
+			});
+		}
+
+		// NOTE: Same as above, except that the part of buffer that has been scanned is removed from the front of buffer.
+		template <size_t max_match_count>
+		size_t find_matches(std::span<const char>& buffer, string_match_t (&matches)[max_match_count]) noexcept {
+			const char* begin = buffer.data();
+			const size_t match_count = find_matches(begin, buffer.data() + buffer.size(), matches);
+			buffer = buffer.subspan(begin - buffer.data());
+			return match_count;
+		}
+
+		// NOTE: Scans buffers[i] with matchers[i], for all of them at the same time, see string_matcher_table_t::scan_interleaved
+		// for why that's faster than scanning them one after the other. Use this if you're juggling multiple streams on one thread anyway,
+		// like a bunch of network connections. The callbacks get each stream's own input stream position.
+		// Returns the number of callbacks that were called.
+		// NOTE: With stats, the streams simply get scanned one after the other, so that every matcher counts it's own.
+		template <size_t stream_count>
+		static size_t scan_interleaved(string_matcher_t* const (&matchers)[stream_count], const std::span<const char> (&buffers)[stream_count]) noexcept {
+			if constexpr (stats_t::is_enabled) {
+				size_t match_count = 0;
+				for (size_t stream_index = 0; stream_index < stream_count; stream_index++) { match_count += matchers[stream_index]->scan(buffers[stream_index]); }
+				return match_count;
+			}
+
+			size_t states[stream_count];
+			size_t input_stream_positions[stream_count];
+			for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+				states[stream_index] = matchers[stream_index]->state;
+				input_stream_positions[stream_index] = matchers[stream_index]->input_stream_position;
+			}
+
+			const size_t match_count = table.scan_interleaved(states, input_stream_positions, buffers,
+				[](size_t stream_index, size_t match_id, size_t position) { callbacks[match_id](position); });
+
+			for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+				matchers[stream_index]->state = states[stream_index];
+				matchers[stream_index]->input_stream_position = input_stream_positions[stream_index];
+			}
+			return match_count;
+		}
+
+		/*
+		   NOTE: The streaming interface. Call feed for every chunk of the stream as it comes in (it's the same thing as scan), and finish
+		   when the stream is over. The chunks can be split anywhere, matches that straddle the boundaries are found all the same, and a
+		   match that ends on the very last character of the stream gets reported by the feed call that contains that character.
+		   finish exists so that the contract is explicit: nothing is ever held back waiting for more input (matches are reported as soon
+		   as their last character comes in, see the top of this file), so there's nothing left to flush at the end, and it always returns 0
+		   (the number of callbacks it called). It doesn't reset anything, call full_reset if you want to reuse the matcher for another stream.
+		   If you need to suspend a stream and pick it back up later, maybe on another thread, save_stream_state gives you everything the
+		   matcher carries between chunks, and restore_stream_state puts it back (it returns false and doesn't change anything if the state
+		   isn't a valid state for this matcher's table).
+		*/
+		size_t feed(std::span<const char> chunk) noexcept { return scan(chunk); }
+
+		size_t finish() noexcept { return 0; }
+
+		string_matcher_stream_state_t save_stream_state() const noexcept { return { state, input_stream_position }; }
+
+		bool restore_stream_state(const string_matcher_stream_state_t& stream_state) noexcept {
+			if (!table.is_valid_state(stream_state.state)) { return false; }
+			state = stream_state.state;
+			input_stream_position = stream_state.input_stream_position;
+			return true;
+		}
+
+		// NOTE: Which of the strings the whole token is (see string_matcher_table_t::lookup), or table_t::no_match_id.
+		// Doesn't touch the matcher's state, so it's static.
+		static constexpr size_t lookup(std::string_view token) noexcept { return table.lookup(token); }
+
+		// NOTE: Same as lookup, except that it calls the callback of the string (with the index of the last character of the token,
+		// same as if the token had been scanned by itself). Returns false if the token isn't one of the strings.
+		static bool lookup_and_call(std::string_view token) noexcept {
+			const size_t match_id = table.lookup(token);
+			if (match_id == table_t::no_match_id) { return false; }
+			callbacks[match_id](token.size() - 1);
+			return true;
+		}
+
+		// NOTE: Doesn't touch the stats, those keep counting across streams until you call reset_stats.
+		void full_reset() noexcept {
+			state = 0;
+			input_stream_position = 0;
+		}
+
+		// NOTE: A copy of the counters as they are right now (see string_matcher_stats_t), so you can keep scanning while you look at them.
+		// lookup, create_cursor and parallel_scan don't go through this matcher's interpreter, so they aren't counted.
+		stats_t stats_snapshot() const noexcept { return stats; }
 
-namespace meta {
+		void reset_stats() noexcept { stats = stats_t(); }
 
-	using size_t = std::size_t;
+		// NOTE: The new cursor starts at the beginning, not wherever this matcher currently is.
+		static constexpr cursor_t create_cursor() noexcept { return cursor_t(table, callbacks); }
+	};
 
-	// NOTE: See srcembed for a detailed explanation of why this works. After reading that, you'll
-	// also understand that [[noreturn]] probably isn't useless here.
-	[[noreturn]] consteval void static_fail_with_msg(const char * const);
+	/*
+	   NOTE: This is the other way of running a table: instead of looking up the next state in memory, the table gets turned into code.
+	   Every state becomes a little function (an instantiation of next_state_index) that compares the character against the characters
+	   that lead somewhere other than the most common destination of that state, and the interpreter picks the function for the current
+	   state with a chain of comparisons. Everything in those comparisons is a compile-time constant, so the compiler turns the chains into
+	   switches (jump tables, bit tests or branch trees, whatever it thinks is best) and there's no table left to load from, apart from the
+	   match ids and output links, which are only looked at when something matched.
+	   IMPORTANT: Whether that's faster depends a lot more on the input than on the size of the spec. The compact table (see
+	   string_matcher_table_t) is only a couple cache lines for small specs and costs two loads per character no matter what, while
+	   the switches cost nothing when the branches are predictable and a lot when they aren't. I measured this: on very regular input
+	   (the same handful of verbs or flags over and over), the switches beat the table by about 30% for specs of around 10 states,
+	   while on random text, the table wins at every size I tried, even with only 5 states, and by 3-4x at 13 states and up.
+	   That's why this doesn't get picked automatically by state count. You have to ask for it with the switch_dispatch flag,
+	   and you should measure with your own input before you do.
+	   The interface is the same as string_matcher_t (callbacks, scan, feed, stream states), except for the interleaved scan,
+	   which only makes sense for the table.
+	   NOTE: state here is the state index, not the row offset, since there are no rows. The stream states are still row offsets though,
+	   so they're interchangeable with the ones from string_matcher_t and cursors for the same table.
+	*/
+	struct switch_transition_t {
+		unsigned char character;
+		size_t target_state_index;
+	};
 
-	struct const_string {
-		const char * const data;
-		const size_t length;
+	struct switch_row_t {
+		size_t default_target_state_index;
+		size_t transition_count;
+		switch_transition_t transitions[string_matcher_character_count];
+	};
 
-		template <size_t size>
-		consteval const_string(const char (&string)[size]) : data(string), length(size - 1) { }
+	// NOTE: Every state is one more function template instantiation, so this is where compile times start to hurt.
+	inline constexpr size_t string_matcher_switch_max_state_count = 256;
+
+	template <const auto& template_table, const auto& template_callbacks>
+	class string_matcher_switch_t {
+	public:
+		static constexpr const auto& table = template_table;
+		static constexpr const auto& callbacks = template_callbacks;
+
+		using table_t = std::remove_cvref_t<decltype(template_table)>;
+		using callbacks_t = std::remove_cvref_t<decltype(template_callbacks)>;
+		using cursor_t = string_matcher_cursor_t<table_t, callbacks_t>;
+
+		static_assert(table_t::length <= string_matcher_switch_max_state_count, "string matcher table is too big for the switch backend");
+
+		size_t state = 0;
+
+		size_t input_stream_position = 0;
+
+	private:
+		static constexpr size_t class_count = table_t::class_count;
+		static constexpr size_t first_accepting_state_index = table.first_accepting_state / class_count;
+
+		static consteval switch_row_t make_switch_row(size_t state_index) {
+			switch_row_t result { };
+
+			size_t target_counts[table_t::length] { };
+			for (size_t character = 0; character < string_matcher_character_count; character++) {
+				target_counts[table.next_state(state_index * class_count, (char)character) / class_count]++;
+			}
+			for (size_t target_state_index = 1; target_state_index < table_t::length; target_state_index++) {
+				if (target_counts[target_state_index] > target_counts[result.default_target_state_index]) { result.default_target_state_index = target_state_index; }
+			}
+
+			for (size_t character = 0; character < string_matcher_character_count; character++) {
+				const size_t target_state_index = table.next_state(state_index * class_count, (char)character) / class_count;
+				if (target_state_index == result.default_target_state_index) { continue; }
+				result.transitions[result.transition_count++] = { (unsigned char)character, target_state_index };
+			}
+			return result;
+		}
+
+		template <size_t state_index>
+		static constexpr switch_row_t switch_row = make_switch_row(state_index);
 
-		consteval const_string(const char* const data, size_t length) : data(data), length(length) { }
+		template <size_t state_index, size_t transition_index>
+		static bool try_transition(unsigned char character, size_t& result) noexcept {
+			constexpr switch_transition_t transition = switch_row<state_index>.transitions[transition_index];
+			if (character != transition.character) { return false; }
+			result = transition.target_state_index;
+			return true;
+		}
+
+		template <size_t state_index, size_t... transition_indices>
+		static size_t next_state_index(unsigned char character, std::index_sequence<transition_indices...>) noexcept {
+			size_t result = switch_row<state_index>.default_target_state_index;
+			(void)(try_transition<state_index, transition_indices>(character, result) || ...);
+			return result;
+		}
+
+		template <size_t... state_indices>
+		static size_t dispatch(size_t state_index, unsigned char character, std::index_sequence<state_indices...>) noexcept {
+			size_t result = 0;
+			(void)((state_index == state_indices
+				&& (result = next_state_index<state_indices>(character, std::make_index_sequence<switch_row<state_indices>.transition_count>()), true)) || ...);
+			return result;
+		}
+
+		static size_t next_state_index(size_t state_index, char character) noexcept {
+			return dispatch(state_index, (unsigned char)character, std::make_index_sequence<table_t::length>());
+		}
+
+		template <typename match_handler_t>
+		static size_t scan_states(size_t& state_index, size_t& input_stream_position, const char* begin, const char* end,
+					  match_handler_t&& match_handler) noexcept {
+			size_t local_state = state_index;
+			size_t local_input_stream_position = input_stream_position;
+			size_t match_count = 0;
+
+			for (const char* character_ptr = begin; character_ptr != end; character_ptr++, local_input_stream_position++) {
+				local_state = next_state_index(local_state, *character_ptr);
+				if (local_state < first_accepting_state_index) { continue; }
+				match_count += table.for_each_match(local_state * class_count, [&](size_t match_id) { match_handler(match_id, local_input_stream_position); });
+			}
+
+			state_index = local_state;
+			input_stream_position = local_input_stream_position;
+			return match_count;
+		}
+
+	public:
+		// NOTE: See string_matcher_t for the details of all of these.
+		bool match_character(char character) noexcept {
+			state = next_state_index(state, character);
+			const size_t position = input_stream_position++;
+			if (state < first_accepting_state_index) { return false; }
+			table.for_each_match(state * class_count, [position](size_t match_id) { callbacks[match_id](position); });
+			return true;
+		}
+
+		size_t scan(const char* begin, const char* end) noexcept {
+			return scan_states(state, input_stream_position, begin, end, [](size_t match_id, size_t position) { callbacks[match_id](position); });
+		}
+
+		size_t scan(std::span<const char> buffer) noexcept { return scan(buffer.data(), buffer.data() + buffer.size()); }
+
+		template <size_t max_match_count>
+		size_t find_matches(const char*& begin, const char* end, string_match_t (&matches)[max_match_count]) noexcept {
+			static_assert(max_match_count >= table.max_matches_per_character, "match buffer is too small, it has to hold at least max_matches_per_character matches");
+			return table.find_matches_blockwise(begin, end, matches, max_match_count, [this](const char* block_begin, const char* block_end, auto&& match_handler) {
+				return scan_states(state, input_stream_position, block_begin, block_end, match_handler);
+			});
+		}
+
+		template <size_t max_match_count>
+		size_t find_matches(std::span<const char>& buffer, string_match_t (&matches)[max_match_count]) noexcept {
+			const char* begin = buffer.data();
+			const size_t match_count = find_matches(begin, buffer.data() + buffer.size(), matches);
+			buffer = buffer.subspan(begin - buffer.data());
+			return match_count;
+		}
+
+		size_t feed(std::span<const char> chunk) noexcept { return scan(chunk); }
+
+		size_t finish() noexcept { return 0; }
+
+		string_matcher_stream_state_t save_stream_state() const noexcept { return { state * class_count, input_stream_position }; }
+
+		bool restore_stream_state(const string_matcher_stream_state_t& stream_state) noexcept {
+			if (!table.is_valid_state(stream_state.state)) { return false; }
+			state = stream_state.state / class_count;
+			input_stream_position = stream_state.input_stream_position;
+			return true;
+		}
+
+		static constexpr size_t lookup(std::string_view token) noexcept { return table.lookup(token); }
+
+		static bool lookup_and_call(std::string_view token) noexcept {
+			const size_t match_id = table.lookup(token);
+			if (match_id == table_t::no_match_id) { return false; }
+			callbacks[match_id](token.size() - 1);
+			return true;
+		}
+
+		void full_reset() noexcept {
+			state = 0;
+			input_stream_position = 0;
+		}
 
-		consteval const char& operator[](size_t index) const { return data[index]; }
+		static constexpr cursor_t create_cursor() noexcept { return cursor_t(table, callbacks); }
+	};
 
-		consteval const_string offset_by(size_t offset) const { return const_string(data + offset, length - offset); }
+	/*
+	   NOTE: The third way of running a spec, for the tiny ones: bit-parallel matching (Shift-And, which is Shift-Or without the inverted bits).
+	   Every element of every string gets one bit in a 64-bit word, the strings one after the other. Bit i of the state is set if the last
+	   few characters matched the string that bit i is in, up to and including element i. One character is then simply
+	   	state = ((state << 1) | start_mask) & class_masks[class of the character]
+	   which moves every partial match one element further (start_mask starts a new one at the first element of every string) and drops the
+	   ones whose next element doesn't match. A string matched if the bit of it's last element is set (end_mask).
+	   The point is that the state never goes through memory: the only load is the mask, and that only depends on the character,
+	   not on the state, so the core can load it way ahead of time. The chain from one character to the next is a shift, an or and an and,
+	   a couple cycles, where the table has two loads (the byte class and the element) that can't start before the previous one is done.
+	   The masks are one per byte class (plus the byte class map, which the table has anyway), so a few hundred bytes at most.
+	   NOTE: CREATE_META_STRING_MATCHER picks this automatically when it gives exactly the same results as the table, which is when
+	   the strings have at most string_matcher_bit_parallel_max_bit_count elements together, and every element is exactly one byte class
+	   (always true for plain strings and case_insensitive, and for character classes that don't get split up, see calculate_byte_classes).
+	   The second part is what makes the state interchangeable with the table's: with one class per element, the table has one state for
+	   every distinct prefix, and the bits say which prefixes the input ends with, so one determines the other (see state_masks).
+	   Duplicate strings are handled like assign_match_ids does it: only the last one gets bits. Overlapping matches come for free (every
+	   string has it's own bits), and longest first comes from the order of the bits: the longest strings get the lowest bits.
+	   IMPORTANT: state is the bit mask, not a row offset. The stream states are row offsets though (see save_stream_state), so they're
+	   interchangeable with the ones from the table and the cursors, same as with string_matcher_switch_t.
+	   NOTE: The bits are a uint64_t for now. Wider masks (128/256 bits with SIMD shifts) would work the same way for bigger specs.
+	*/
+	inline constexpr size_t string_matcher_bit_parallel_max_bit_count = 64;
+
+	template <typename table_t>
+	struct bit_parallel_masks_t {
+		uint64_t class_masks[table_t::class_count];
+		uint64_t start_mask;
+		uint64_t end_mask;
+		typename table_t::match_id_t end_bit_match_ids[string_matcher_bit_parallel_max_bit_count];
+		// NOTE: The bit mask for every state of the table, for converting between the two (see save_stream_state).
+		uint64_t state_masks[table_t::length];
 	};
 
-	consteval size_t calculate_table_length(const const_string& meta_matcher_spec) {
-		size_t result = 0;
+	/*
+	   NOTE: Collects the strings of the spec for the bit-parallel matcher: the byte class of every element (in classes, one string after
+	   the other), and where every string starts, how long it is and what it's match id is (empty strings and strings that show up again
+	   later are left out). Returns the number of bits they need, or (size_t)-1 if there's an element that's more than one class,
+	   in which case the bit-parallel matcher can't do what the table does.
+	*/
+	constexpr size_t collect_bit_parallel_strings(const const_string& meta_matcher_spec, const unsigned char (&byte_classes)[string_matcher_character_count],
+						     compile_time_array_t<size_t>& classes, compile_time_array_t<size_t>& string_begins,
+						     compile_time_array_t<size_t>& string_lengths, compile_time_array_t<size_t>& string_match_ids) {
+		constexpr size_t no_class = string_matcher_character_count;
+		for (size_t i = 0, match_id = 0; ; match_id++) {
+			const size_t string_begin = classes.size;
+			while (i < meta_matcher_spec.length && meta_matcher_spec[i] != '|') {
+				size_t element_class = no_class;
+				bool is_one_class = true;
+				i = for_each_element_byte(meta_matcher_spec, i, [&](unsigned char character) {
+					if (element_class == no_class) { element_class = byte_classes[character]; }
+					is_one_class = is_one_class && byte_classes[character] == element_class;
+				});
+				if (!is_one_class) { return (size_t)-1; }
+				classes.push_back(element_class);
+			}
 
-		/*
-		   We could use pointers for this loop stuff instead of indices in the hopes of making compile times shorter,
-		   but who knows how much the compiler optimizes these consteval functions before interpreting them anyway.
-		   I'm gonna simply rely on optimizations like I would if I were writing this for runtime, for the sake of expressiveness.
-		   If the compile times get too bad, I'll do something about it then, when I know for sure that it's necessary.
-		   One also has to remember, compilers will get better in the future and optimize these types of functions more and more,
-		   so this code will compile faster and faster.
-		*/
-		for (size_t i = 0; i < meta_matcher_spec.length; i++) {
-			unsigned char character = meta_matcher_spec[i];
-			// NOTE: This if could be done away with if we used a table, but it's not a big deal, see below.
-			if (character > 127) { static_fail_with_msg("invalid character (not in ASCII range) present in matcher specification"); }
-			// NOTE: UTF8 contains ASCII, so even if that encoding is used, this check will still only filter out unwanted stuff.
-			// As for systems that don't use ASCII or UTF8 for their character encoding in C++,
-			// we're just gonna ignore those for now. I don't even know of any, very uncommon I guess.
-
-			switch (character) {
-			case '|': continue;
-			case '\\':
-				i++;
-				if (i == meta_matcher_spec.length) {
-					static_fail_with_msg("backslash ('\\') character cannot appear at end of matcher specification");
+			if (classes.size != string_begin) {
+				string_begins.push_back(string_begin);
+				string_lengths.push_back(classes.size - string_begin);
+				string_match_ids.push_back(match_id);
+			}
+			if (i == meta_matcher_spec.length) { break; }
+			i++;
+		}
+
+		size_t bit_count = 0;
+		for (size_t j = 0; j < string_begins.size; j++) {
+			for (size_t k = j + 1; k < string_begins.size; k++) {
+				if (string_lengths[j] != string_lengths[k]) { continue; }
+				bool is_duplicate = true;
+				for (size_t l = 0; l < string_lengths[j] && is_duplicate; l++) { is_duplicate = classes[string_begins[j] + l] == classes[string_begins[k] + l]; }
+				// NOTE: The later one wins, same as in assign_match_ids. The length is simply set to 0, so that the string gets no bits.
+				if (is_duplicate) {
+					string_lengths[j] = 0;
+					break;
 				}
+			}
+			bit_count += string_lengths[j];
+		}
+		return bit_count;
+	}
 
-				character = meta_matcher_spec[i];
-				if (character > 127) { static_fail_with_msg("invalid character (not in ASCII range) present in matcher specification"); }
+	constexpr bool is_bit_parallel_usable(const const_string& meta_matcher_spec) {
+		unsigned char byte_classes[string_matcher_character_count];
+		calculate_byte_classes(meta_matcher_spec, byte_classes);
+		compile_time_array_t<size_t> classes;
+		compile_time_array_t<size_t> string_begins;
+		compile_time_array_t<size_t> string_lengths;
+		compile_time_array_t<size_t> string_match_ids;
+		return collect_bit_parallel_strings(meta_matcher_spec, byte_classes, classes, string_begins, string_lengths, string_match_ids)
+			<= string_matcher_bit_parallel_max_bit_count;
+	}
 
-				// NOTE: Nested switches are technically less efficient than state tables,
-				// but it's not that big of a deal for now. The expressiveness of this outweighs
-				// it's cost, at least in compile-time.
-				switch (character) {
-				case '|': case '\\': result++; continue;
-				default: static_fail_with_msg("invalid character following backslash ('\\') character in matcher specification");
-				}
-			default: result++; continue;
+	template <typename table_t>
+	consteval bit_parallel_masks_t<table_t> calculate_bit_parallel_masks(const const_string& meta_matcher_spec, const table_t& table) {
+		bit_parallel_masks_t<table_t> result { };
+
+		unsigned char byte_classes[string_matcher_character_count];
+		for (size_t character = 0; character < string_matcher_character_count; character++) { byte_classes[character] = table.byte_classes[character]; }
+		compile_time_array_t<size_t> classes;
+		compile_time_array_t<size_t> string_begins;
+		compile_time_array_t<size_t> string_lengths;
+		compile_time_array_t<size_t> string_match_ids;
+		const size_t bit_count = collect_bit_parallel_strings(meta_matcher_spec, byte_classes, classes, string_begins, string_lengths, string_match_ids);
+		if (bit_count > string_matcher_bit_parallel_max_bit_count) { static_fail_with_msg("internal error, spec is too big for the bit-parallel matcher"); }
+
+		// NOTE: Longest strings first, so that going through the end bits from the lowest one up reports the longest match first.
+		size_t longest_string_length = 0;
+		for (size_t j = 0; j < string_lengths.size; j++) { if (string_lengths[j] > longest_string_length) { longest_string_length = string_lengths[j]; } }
+		size_t next_bit = 0;
+		for (size_t string_length = longest_string_length; string_length != 0; string_length--) {
+			for (size_t j = 0; j < string_lengths.size; j++) {
+				if (string_lengths[j] != string_length) { continue; }
+				result.start_mask |= (uint64_t)1 << next_bit;
+				for (size_t l = 0; l < string_length; l++) { result.class_masks[classes[string_begins[j] + l]] |= (uint64_t)1 << (next_bit + l); }
+				next_bit += string_length;
+				result.end_mask |= (uint64_t)1 << (next_bit - 1);
+				result.end_bit_match_ids[next_bit - 1] = string_match_ids[j];
 			}
 		}
 
+		// NOTE: Breadth-first from the root, the first time a state is reached is through the characters of it's prefix (every other way
+		// there is longer), so the state's mask is simply the mask of the state it came from, one step further.
+		bool is_visited[table_t::length] { };
+		size_t queue[table_t::length];
+		queue[0] = 0;
+		is_visited[0] = true;
+		for (size_t queue_front = 0, queue_back = 1; queue_front != queue_back; queue_front++) {
+			const size_t state_index = queue[queue_front];
+			for (size_t byte_class = 0; byte_class < table_t::class_count; byte_class++) {
+				const size_t next_state_index = table.data[state_index * table_t::class_count + byte_class] / table_t::class_count;
+				if (is_visited[next_state_index]) { continue; }
+				is_visited[next_state_index] = true;
+				result.state_masks[next_state_index] = ((result.state_masks[state_index] << 1) | result.start_mask) & result.class_masks[byte_class];
+				queue[queue_back++] = next_state_index;
+			}
+		}
 		return result;
 	}
 
-	struct string_matcher_with_indices_table_element_t {
-		size_t next_state;
-		void (*callback)(size_t);	// NOTE: callbacks get called with the position in the input character stream as the only parameter
-	};
+	template <const const_string& meta_matcher_spec, const auto& template_table, const auto& template_callbacks>
+	class string_matcher_bit_parallel_t {
+	public:
+		static constexpr const auto& table = template_table;
+		static constexpr const auto& callbacks = template_callbacks;
+
+		using table_t = std::remove_cvref_t<decltype(template_table)>;
+		using callbacks_t = std::remove_cvref_t<decltype(template_callbacks)>;
+		using cursor_t = string_matcher_cursor_t<table_t, callbacks_t>;
+
+		static constexpr bit_parallel_masks_t<table_t> masks = calculate_bit_parallel_masks(meta_matcher_spec, table);
 
-	inline constexpr size_t string_matcher_table_width = (size_t)(unsigned char)-1 + 1;
-	// NOTE: We make the table as wide as the the num of values representable by char (which we elsewhere make sure is not bigger than 1 byte),
-	// so that non-ASCII characters can be correctly identified as invalid without extra overhead when following the table.
+		uint64_t state = 0;
+
+		size_t input_stream_position = 0;
+
+	private:
+		static uint64_t next_state(uint64_t state, char character) noexcept {
+			return ((state << 1) | masks.start_mask) & masks.class_masks[table.byte_classes[(unsigned char)character]];
+		}
+
+		template <typename match_handler_t>
+		static size_t for_each_match(uint64_t state, match_handler_t&& match_handler) noexcept {
+			size_t match_count = 0;
+			for (uint64_t end_bits = state & masks.end_mask; end_bits != 0; end_bits &= end_bits - 1) {
+				match_handler((size_t)masks.end_bit_match_ids[__builtin_ctzll(end_bits)]);
+				match_count++;
+			}
+			return match_count;
+		}
+
+		// NOTE: Same loop as string_matcher_table_t::scan, prefilter and all. A state of 0 is the root.
+		template <typename match_handler_t>
+		static size_t scan_states(uint64_t& state, size_t& input_stream_position, const char* begin, const char* end, match_handler_t&& match_handler) noexcept {
+			uint64_t local_state = state;
+			size_t local_input_stream_position = input_stream_position;
+			size_t match_count = 0;
+			size_t stretch_length = 1;
+
+			for (const char* character_ptr = begin; character_ptr != end; ) {
+				if (local_state == 0 && table.has_prefilter()) {
+					const char* candidate_ptr = table.find_first_byte(character_ptr, end);
+					stretch_length = (size_t)(candidate_ptr - character_ptr) < table.prefilter_min_skip_length ? table.prefilter_backoff_length : 1;
+					local_input_stream_position += candidate_ptr - character_ptr;
+					character_ptr = candidate_ptr;
+				}
+
+				const char* stretch_end = (size_t)(end - character_ptr) > stretch_length ? character_ptr + stretch_length : end;
+				for (; character_ptr != stretch_end; character_ptr++, local_input_stream_position++) {
+					local_state = next_state(local_state, *character_ptr);
+					if ((local_state & masks.end_mask) == 0) { continue; }
+					match_count += for_each_match(local_state, [&](size_t match_id) { match_handler(match_id, local_input_stream_position); });
+				}
+			}
+
+			state = local_state;
+			input_stream_position = local_input_stream_position;
+			return match_count;
+		}
 
-	template <size_t template_length>
-	class string_matcher_with_indices_t {
 	public:
-		static constexpr size_t length = template_length;
+		// NOTE: See string_matcher_t for the details of all of these.
+		bool match_character(char character) noexcept {
+			state = next_state(state, character);
+			const size_t position = input_stream_position++;
+			return for_each_match(state, [position](size_t match_id) { callbacks[match_id](position); }) != 0;
+		}
 
-		string_matcher_with_indices_table_element_t data[length][string_matcher_table_width];
-		// NOTE: Doesn't have to be a 1D array because this table uses indices and not pointers. See below.
-	};
+		size_t scan(const char* begin, const char* end) noexcept {
+			return scan_states(state, input_stream_position, begin, end, [](size_t match_id, size_t position) { callbacks[match_id](position); });
+		}
+
+		size_t scan(std::span<const char> buffer) noexcept { return scan(buffer.data(), buffer.data() + buffer.size()); }
+
+		template <size_t max_match_count>
+		size_t find_matches(const char*& begin, const char* end, string_match_t (&matches)[max_match_count]) noexcept {
+			static_assert(max_match_count >= table.max_matches_per_character, "match buffer is too small, it has to hold at least max_matches_per_character matches");
+			return table.find_matches_blockwise(begin, end, matches, max_match_count, [this](const char* block_begin, const char* block_end, auto&& match_handler) {
+				return scan_states(state, input_stream_position, block_begin, block_end, match_handler);
+			});
+		}
+
+		template <size_t max_match_count>
+		size_t find_matches(std::span<const char>& buffer, string_match_t (&matches)[max_match_count]) noexcept {
+			const char* begin = buffer.data();
+			const size_t match_count = find_matches(begin, buffer.data() + buffer.size(), matches);
+			buffer = buffer.subspan(begin - buffer.data());
+			return match_count;
+		}
+
+		// NOTE: Every stream is only a couple ALU instructions per character here, so this doesn't gain as much as it does with the table,
+		// but it keeps the interface the same.
+		template <size_t stream_count>
+		static size_t scan_interleaved(string_matcher_bit_parallel_t* const (&matchers)[stream_count], const std::span<const char> (&buffers)[stream_count]) noexcept {
+			static_assert(stream_count != 0, "scan_interleaved needs at least one stream");
+
+			size_t common_length = buffers[0].size();
+			for (size_t stream_index = 1; stream_index < stream_count; stream_index++) {
+				if (buffers[stream_index].size() < common_length) { common_length = buffers[stream_index].size(); }
+			}
+
+			uint64_t states[stream_count];
+			for (size_t stream_index = 0; stream_index < stream_count; stream_index++) { states[stream_index] = matchers[stream_index]->state; }
+			size_t match_count = 0;
+
+			for (size_t i = 0; i < common_length; i++) {
+				for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+					states[stream_index] = next_state(states[stream_index], buffers[stream_index][i]);
+				}
+				for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+					if ((states[stream_index] & masks.end_mask) == 0) { continue; }
+					const size_t position = matchers[stream_index]->input_stream_position + i;
+					match_count += for_each_match(states[stream_index], [position](size_t match_id) { callbacks[match_id](position); });
+				}
+			}
 
-	struct string_matcher_table_element_t {
-		string_matcher_table_element_t *next_state_ptr;
-		void (*callback)(size_t);
+			for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+				matchers[stream_index]->state = states[stream_index];
+				matchers[stream_index]->input_stream_position += common_length;
+				match_count += matchers[stream_index]->scan(buffers[stream_index].subspan(common_length));
+			}
+			return match_count;
+		}
+
+		size_t feed(std::span<const char> chunk) noexcept { return scan(chunk); }
+
+		size_t finish() noexcept { return 0; }
+
+		// NOTE: Every mask that the matcher can end up with is the mask of exactly one state of the table (see bit_parallel_masks_t),
+		// so we simply look for it. There are at most string_matcher_bit_parallel_max_bit_count + 1 states, and this isn't the hot path.
+		string_matcher_stream_state_t save_stream_state() const noexcept {
+			size_t state_index = 0;
+			while (state_index < table_t::length && masks.state_masks[state_index] != state) { state_index++; }
+			return { state_index * table_t::class_count, input_stream_position };
+		}
+
+		bool restore_stream_state(const string_matcher_stream_state_t& stream_state) noexcept {
+			if (!table.is_valid_state(stream_state.state)) { return false; }
+			state = masks.state_masks[stream_state.state / table_t::class_count];
+			input_stream_position = stream_state.input_stream_position;
+			return true;
+		}
+
+		static constexpr size_t lookup(std::string_view token) noexcept { return table.lookup(token); }
+
+		static bool lookup_and_call(std::string_view token) noexcept {
+			const size_t match_id = table.lookup(token);
+			if (match_id == table_t::no_match_id) { return false; }
+			callbacks[match_id](token.size() - 1);
+			return true;
+		}
+
+		void full_reset() noexcept {
+			state = 0;
+			input_stream_position = 0;
+		}
+
+		static constexpr cursor_t create_cursor() noexcept { return cursor_t(table, callbacks); }
 	};
 
-	template <size_t template_length>
-	class string_matcher_t {
+	// NOTE: The type CREATE_META_STRING_MATCHER declares the matcher as, depending on the flags in the spec (and it's size, see
+	// string_matcher_bit_parallel_t).
+	template <const const_string& meta_matcher_spec, const auto& table, const auto& callbacks>
+	using string_matcher_for_spec_t = std::conditional_t<(meta_matcher_spec.flags & switch_dispatch) != 0, string_matcher_switch_t<table, callbacks>,
+							     std::conditional_t<is_bit_parallel_usable(meta_matcher_spec),
+										string_matcher_bit_parallel_t<meta_matcher_spec, table, callbacks>,
+										string_matcher_t<table, callbacks>>>;
+
+	/*
+	   NOTE: The callbacks of string_matcher_t are function pointers in an array, so every match is an indirect call that the compiler
+	   can't see through, and since they have to be function pointers, they can't capture anything. This one keeps the handlers themselves
+	   (lambdas with captures, function objects, whatever can be called with a size_t) in the matcher, and their types in it's template
+	   parameters. The table doesn't change at all, it already only has match ids in it. The match id gets turned into a call with a
+	   fold over all the handlers (match_id == 0 && call handler 0, || match_id == 1 && ...), which the compiler turns into a switch
+	   with every handler inlined right into it, and that gets inlined into the scan loop. So no indirect calls, no mispredicted
+	   indirect jumps on match-dense input, and the handler code gets optimized together with the loop.
+	   Create it with CREATE_META_STRING_MATCHER_WITH_HANDLERS (see the bottom of this file). It's got the same interface as string_matcher_t,
+	   except that there's no create_cursor (a cursor only has a pointer to an array of function pointers) and no scan_interleaved.
+	   NOTE: Unlike string_matcher_t, this isn't empty apart from the state, it also holds the handlers (and whatever they captured).
+	   Copying it copies them.
+	*/
+	template <const auto& template_table, typename... handler_types>
+	class string_matcher_with_handlers_t {
 	public:
-		static constexpr size_t length = template_length;
+		static constexpr const auto& table = template_table;
 
-		string_matcher_table_element_t data[length][string_matcher_table_width];
+		using table_t = std::remove_cvref_t<decltype(template_table)>;
 
-		// NOTE: The below comment is from when we we're interfacing with this class from compile-time.
-		// Now, we're doing that from runtime but basically expecting the compiler to optimize, which is a different situation.
-		// In that situation, it is most likely still UB to do the pointer stuff with a 2D array, but the compiler won't
-		// complain because it isn't a compile-time function, so we do it anyway.
-		/*
-		   I wanted to use a 2D array, but C++ wouldn't let me because of the way compile-time functions works:
-		   Basically, we've got a pointer down there somewhere that points to the first element of some row, the row is subject to change
-		   as part of the algorithm. The way we initialized the pointer before was:
-		   type* ptr = string_matcher.data[0]
-		   --> which is the pointer to the first element of the first row
-		   We then proceeded to add row-sized sizes to the pointer one after another, but that is what messes up interpretation.
-		   I always thought the compiler tracked all the regions of the objects that were currently allocated at compile-time
-		   and made sure that every pointer access was always in one of those regions, which would have been pretty cool.
-		   Instead, probably because of the C++ spec rule that basically says a pointer to an object must remain inside that object, unless
-		   it's only one past the end of the object (I think they weren't thinking hard enough when they formulated that rule,
-		   because as it stands, it makes a couple of useful things UB), every pointer in compile-time functions is
-		   associated with it's object and can't leave the region for that object.
-		   Now, of course the compiler considers the sub-array 0 of string_matcher.data to be the pointers object, so it essentially
-		   can't leave the first row of the string_matcher.
-		   That's why we had to use a 1D array instead, because now the whole array is the object of the pointer and it can move around
-		   freely.
-		   NOTE: Technically, the exact same rule applies to runtime as well, it just can't get enforced like it can at compile-time.
-		   While it technically is UB, like I said, it's very useful sometimes, and I assume basically all implementations
-		   implement it correctly rather than keeping it UB, which is why at runtime, I will continue to use it.
-		   NOTE: This could easily be standardized and implemented differently (like I said above with the regions and the tracking),
-		   but apparently logic is something the language designers don't have too good a grasp on at times.
-		*/
+		static_assert(sizeof...(handler_types) == table_t::match_count,
+			      "failed to create string matcher, number of handlers doesn't match number of strings in matcher specification");
 
-		const string_matcher_table_element_t* state = data[0];
+		std::tuple<handler_types...> handlers;
 
-		size_t input_stream_position_at_last_match;
-		void (*callback_ptr_at_last_match)(size_t) = nullptr;
+		size_t state = 0;
 
 		size_t input_stream_position = 0;
 
-		bool match_character(char character) noexcept {
-			const unsigned char unsigned_character = character;
-			if (state[unsigned_character].callback) {
-				callback_ptr_at_last_match = state[unsigned_character].callback;
-				input_stream_position_at_last_match = input_stream_position;
-			}
-			input_stream_position++;
-			if (!state[unsigned_character].next_state_ptr) {
-				state = data[0];
-				if (!callback_ptr_at_last_match) { return false; }
-				callback_ptr_at_last_match(input_stream_position_at_last_match);
-				callback_ptr_at_last_match = nullptr;
-				return true;
-			}
-			state = state[unsigned_character].next_state_ptr;
-			return false;
+		constexpr string_matcher_with_handlers_t(handler_types... handler_arguments) : handlers(std::move(handler_arguments)...) { }
+
+	private:
+		template <size_t... match_ids>
+		void call_handler(size_t match_id, size_t position, std::index_sequence<match_ids...>) {
+			(void)((match_id == match_ids && (std::get<match_ids>(handlers)(position), true)) || ...);
+		}
+
+		void call_handler(size_t match_id, size_t position) { call_handler(match_id, position, std::index_sequence_for<handler_types...>()); }
+
+	public:
+		bool match_character(char character) {
+			return table.match_character(state, input_stream_position, character,
+						     [this](size_t match_id, size_t position) { call_handler(match_id, position); });
+		}
+
+		size_t scan(const char* begin, const char* end) {
+			return table.scan(state, input_stream_position, begin, end, [this](size_t match_id, size_t position) { call_handler(match_id, position); });
+		}
+
+		size_t scan(std::span<const char> buffer) { return scan(buffer.data(), buffer.data() + buffer.size()); }
+
+		template <size_t max_match_count>
+		size_t find_matches(const char*& begin, const char* end, string_match_t (&matches)[max_match_count]) noexcept {
+			static_assert(max_match_count >= table.max_matches_per_character, "match buffer is too small, it has to hold at least max_matches_per_character matches");
+			return table.find_matches(state, input_stream_position, begin, end, matches, max_match_count);
+		}
+
+		template <size_t max_match_count>
+		size_t find_matches(std::span<const char>& buffer, string_match_t (&matches)[max_match_count]) noexcept {
+			const char* begin = buffer.data();
+			const size_t match_count = find_matches(begin, buffer.data() + buffer.size(), matches);
+			buffer = buffer.subspan(begin - buffer.data());
+			return match_count;
+		}
+
+		size_t feed(std::span<const char> chunk) { return scan(chunk); }
+
+		size_t finish() noexcept { return 0; }
+
+		string_matcher_stream_state_t save_stream_state() const noexcept { return { state, input_stream_position }; }
+
+		bool restore_stream_state(const string_matcher_stream_state_t& stream_state) noexcept {
+			if (!table.is_valid_state(stream_state.state)) { return false; }
+			state = stream_state.state;
+			input_stream_position = stream_state.input_stream_position;
+			return true;
+		}
+
+		static constexpr size_t lookup(std::string_view token) noexcept { return table.lookup(token); }
+
+		bool lookup_and_call(std::string_view token) {
+			const size_t match_id = table.lookup(token);
+			if (match_id == table_t::no_match_id) { return false; }
+			call_handler(match_id, token.size() - 1);
+			return true;
 		}
 
 		void full_reset() noexcept {
-			state = data[0];
-			callback_ptr_at_last_match = nullptr;
+			state = 0;
 			input_stream_position = 0;
 		}
 	};
 
+	// NOTE: For CREATE_META_STRING_MATCHER_WITH_HANDLERS, so that the handler types get deduced. They're stored by value (decayed),
+	// so if you want a handler to refer to something big, capture it by reference.
+	template <const auto& table, typename... handler_types>
+	constexpr auto create_string_matcher_with_handlers(handler_types&&... handlers) {
+		return string_matcher_with_handlers_t<table, std::decay_t<handler_types>...>(std::forward<handler_types>(handlers)...);
+	}
+
 	// NOTE: The below function doesn't work because compile-time functions can't change variables outside of their scope.
 	// They're pure functional as far as I can tell, or rather every thing a compile-time function can do, a pure functional function can do,
 	// maybe not the other way around.
@@ -223,6 +2158,7 @@ namespace meta {
 		func_ptr_t data[length];
 
 		consteval func_ptr_t& operator[](size_t index) { return data[index]; }
+		constexpr const func_ptr_t& operator[](size_t index) const noexcept { return data[index]; }
 	};
 
 	template <typename... func_ret_types>
@@ -251,17 +2187,6 @@ namespace meta {
 		consteval operator bool() const { return true; }
 	};
 
-	// NOTE: Empty structs/classes are well defined in the C++ spec (although being UB in the C spec).
-	// The following line is totally valid, there is one thing you have to watch out for though: sizeof(zero_out_t) is never equal to zero.
-	// It must at minimum be 1, but the implementation can define exactly how big, so it could be 50 or 1000, although that practically
-	// never happens (so don't worry about taking up space, AFAIK it's 1 most of the time).
-	// REASONING: A struct with size 0 could technically be located at the exact same spot as another struct, because it doesn't
-	// take up any memory, and that doesn't make any sense. Think about it this way: what would an array of these structs look like?
-	// The more I think about it, the more I think one could make everything work with 0-sized empty structs, but I guess the
-	// designers chose not to go down that route to avoid causing unnecessary confusion.
-	// TODO: Research more about this.
-	struct zero_out_t { } zero_out;
-
 	// NOTE: I know the stdlib has one of these, but I wanted to make my own.
 	// NOTE: Interestingly, C++ has the facility to deduce class template args from a constructor call, but I think
 	// that would require me to forgoe the forwarding and create two separate contructors for rvalue refs and lvalue refs.
@@ -317,201 +2242,158 @@ not even rely on SFINAE.
 		return pair_with_compile_time_second_t<std::remove_reference_t<first_ref_t>, decltype(second_value), second_value>(std::forward<first_ref_t>(first));
 	}
 
-	template <size_t table_length, typename... func_ret_types>
-	consteval auto compile_to_table(const const_string& meta_matcher_spec, func_ret_types (*...func_ptrs)(size_t)) {
-		static_assert(sizeof...(func_ptrs) != 0, "failed to create string matcher, no callbacks provided");
-		//func_ptr_array_wrapper_t<sizeof...(func_ptrs)> func_ptr_array = convert_func_ptr_pack_to_array(func_ptrs...);
-		// TODO: The above causes clang to bug out. Presumably same bug as the other spots where this happens. REPORT!!!!!
-		// TODO: This and the other bugs in this file might be totally gone now that I've updated my clang version, test that out!
-		func_ptr_array_wrapper_t<sizeof...(func_ptrs)> func_ptr_array;
-		func_ptr_array = convert_func_ptr_pack_to_array(func_ptrs...);
+	/*
+	   NOTE: The second half of compile_to_table, which doesn't care where the table lives, so that runtime tables get built the exact same way
+	   (see meta_string_match_runtime.h). result only needs the members of string_matcher_table_storage_t, either as arrays or as pointers,
+	   with byte_classes already filled in and everything else zeroed out. transitions, match_ids and output_links are what
+	   build_automaton made (table_length states of it), either as compile_time_array_t's or as the arrays in built_automaton_t.
+	*/
+	template <typename transitions_t, typename state_array_t, typename result_t>
+	constexpr void write_string_matcher_table(const const_string& meta_matcher_spec, size_t class_count, size_t no_match_id, size_t table_length,
+						  const transitions_t& transitions, const state_array_t& match_ids,
+						  const state_array_t& output_links, result_t& result) {
+		// NOTE: The accepting states go at the end, see string_matcher_table_t. Other than that, the states are in breadth-first order, which
+		// keeps the states that are close to the root (the ones that get visited the most) close together in memory.
+		compile_time_array_t<size_t> breadth_first_order;
+		compile_time_array_t<bool> is_queued;
+		breadth_first_order.push_back(0);
+		is_queued.resize(table_length, false);
+		is_queued[0] = true;
+		for (size_t queue_front = 0; queue_front != breadth_first_order.size; queue_front++) {
+			const size_t row = breadth_first_order[queue_front];
+			for (size_t byte_class = 0; byte_class < class_count; byte_class++) {
+				const size_t next_row = transitions[row * class_count + byte_class];
+				if (is_queued[next_row]) { continue; }
+				is_queued[next_row] = true;
+				breadth_first_order.push_back(next_row);
+			}
+		}
+		// NOTE: The extra states for strings that end in the same node as another one (see assign_match_ids) can't be reached from
+		// the root, they're only in output chains. They go at the end.
+		for (size_t row = 0; row < table_length; row++) {
+			if (!is_queued[row]) { breadth_first_order.push_back(row); }
+		}
+
+		compile_time_array_t<size_t> new_state_indices;
+		new_state_indices.resize(table_length, 0);	// NOTE: The root stays 0.
+		size_t next_new_state_index = 1;
+		for (size_t accepting_pass = 0; accepting_pass < 2; accepting_pass++) {
+			if (accepting_pass == 1) { result.first_accepting_state = next_new_state_index * class_count; }
+			for (size_t i = 1; i < table_length; i++) {
+				const size_t row = breadth_first_order[i];
+				const bool is_accepting = match_ids[row] != no_match_id;
+				if (is_accepting == (accepting_pass == 1)) { new_state_indices[row] = next_new_state_index++; }
+			}
+		}
+
+		for (size_t row = 0; row < table_length; row++) {
+			const size_t new_row = new_state_indices[row];
+			for (size_t byte_class = 0; byte_class < class_count; byte_class++) {
+				result.data[new_row * class_count + byte_class] = new_state_indices[transitions[row * class_count + byte_class]] * class_count;
+			}
+
+			if (match_ids[row] == no_match_id) { continue; }
+			result.match_ids[new_row] = match_ids[row];
+			result.output_links[new_row] = new_state_indices[output_links[row]] * class_count;
+		}
+
+		for (size_t string_begin = 0, match_id = 0; ; match_id++) {
+			result.match_lengths[match_id] = calculate_string_length(meta_matcher_spec, string_begin);
+			const size_t string_end = find_string_end(meta_matcher_spec, string_begin);
+			if (string_end == meta_matcher_spec.length) { break; }
+			string_begin = string_end + 1;
+		}
+
+		for (size_t row = result.first_accepting_state / class_count; row < table_length; row++) {
+			size_t chain_length = 0;
+			for (size_t output_state = row * class_count; output_state != 0; output_state = result.output_links[output_state / class_count]) { chain_length++; }
+			if (chain_length > result.max_matches_per_character) { result.max_matches_per_character = chain_length; }
+		}
+
+		// NOTE: The first bytes are simply the characters that lead out of the root, for the prefilter in scan.
+		for (size_t character = 0; character < string_matcher_character_count; character++) {
+			if (result.data[result.byte_classes[character]] == 0) { continue; }
+			if (result.first_byte_count < string_matcher_prefilter_max_first_byte_count) { result.first_bytes[result.first_byte_count] = character; }
+			result.first_byte_count++;
+		}
+	}
 
-		// NOTE: We zero the table out because the error state of an element is when the next_state size_t is 0.
-		// Probably the fastest way to do it because the interpreter can do it in a couple operations instead of interpreting a memset or
-		// something.
+	template <size_t table_length, size_t class_count, size_t match_count, size_t longest_match_length, typename automaton_t>
+	consteval auto compile_to_table(const const_string& meta_matcher_spec, const automaton_t& automaton) {
+		using result_t = string_matcher_table_t<table_length, class_count, match_count, longest_match_length>;
+
+		// NOTE: We zero the table out because all of the bookkeeping below relies on 0 meaning "nothing here yet".
 		// NOTE: The classic { } doesn't work here because it's not a POD type. It's got a custom constructor and no
 		// default constructor, meaning { } can't even default to default initialization.
 		// Instead, I've added another constructor that does the zeroing out by value initializing the
 		// member variables. If those aren't zero initializable that's a problem, but they are in this case so it's fine.
-		pair_t<string_matcher_with_indices_t<table_length>, size_t> result_pair(zero_out);
-		auto& string_matcher_with_indices = result_pair.first;
+		result_t result(zero_out);
+		calculate_byte_classes(meta_matcher_spec, result.byte_classes);
 
 		/*
-		   IMPORTANT: Setting the next_state_ptr's from this function doesn't really work because when you copy the object
-		   to the outside, those pointers don't refer to the correct spots anymore. I've thought about it, and the only way to
-		   counter-act this is to construct the state table with indices in this function, return that, and then
-		   convert the index table into a ptr table outside of this function, which is also (by necessity) outside of compile-time.
-		   This isn't a big deal though because the compiler will almost definitely optimize.
-		   This does however require that you compile with optimization enabled, which is kind of a shame, but not too big an issue.
-		   IMPORTANT: Also, you're not even allowed to return addresses to local variables from compile-time functions,
-		   because that would stop them from being deterministic, so that's important to remember as well.
+		   IMPORTANT: This table used to contain pointers, and setting those from this function didn't really work because when you copy the object
+		   to the outside, those pointers don't refer to the correct spots anymore. Also, you're not even allowed to return addresses to
+		   local variables from compile-time functions, because that would stop them from being deterministic.
 		   IMPORTANT: You might think that you could counter-act this by using static variables inside the compile-time function,
 		   which would then also be in the scope of the caller and thereby not violate this rule, but that's incorrect.
 		   YOU CAN'T USE STATIC VARIABLES IN COMPILE-TIME FUNCTIONS! For obvious reasons, the way static variables work
 		   inherently breaks determinism, so their not allowed.
+		   That's why the table is made of row offsets now, those survive the copy just fine.
 		*/
 
-		size_t table_row = 0;
-		size_t last_table_row;
-		size_t merge_row_current = 0;
-		size_t last_merge_row;
-		size_t i = 0;			// index into the matcher spec
-		size_t string_index = 0;	// used to get the correct function pointer for the end elements
-
-		unsigned char character = -1;
-		unsigned char last_character;
-
-		while (true) {
-			for (; i < meta_matcher_spec.length; i++) {
-				// NOTE: This is due to the same bug as below, see comment below.
-				//unsigned char character;
-				//character = meta_matcher_spec[i];
-				// That's how it was.
-
-				last_character = character;
-				character = meta_matcher_spec[i];
-				if (character > 127) {
-					static_fail_with_msg("invalid character (not in ASCII range) present in matcher specification");
-				}
-
-				switch (character) {
-				case '|':
-					if (last_character != -1) {
-						// NOTE: We don't set last_table_row on purpose here, don't worry.
-						string_matcher_with_indices.data[last_table_row][last_character] = { 0, func_ptr_array[string_index] };
-						character = -1;		// to make sure that empty strings don't mess up the system
-					}
-					string_index++;
-					i++;
-					break;
-				case '\\':
-					i++;
-					if (i == meta_matcher_spec.length) {
-						static_fail_with_msg("backslash ('\\') character cannot appear at end of matcher specification");
-					}
-
-					last_character = character;
-					character = meta_matcher_spec[i];
-					if (character > 127) {
-						static_fail_with_msg("invalid character (not in ASCII range) present in matcher specification");
-					}
-					// fallthrough
-				default:
-					last_table_row = table_row;
-					// IMPORTANT: The right side of this gets evaluated first and then the assignment is done.
-					// This is deadly if your doing a[var] = ++var and expecting it to
-					// basically be a[4] = 5;      BE VERY CAREFUL WITH THIS STUFF!
-					string_matcher_with_indices.data[last_table_row][character] = { ++table_row, nullptr };
-					continue;
-				}
-				break;		// NOTE: We're forced into doing this because consteval's don't allow goto.
-			}
-
-			for (; i < meta_matcher_spec.length; i++) {
-				//char character = meta_matcher_spec[i]; <-- THIS DOESN'T WORK!!! PROBS CLANG BUG!!! TODO: RESEARCH AND REPORT!!!!
-				last_character = character;
-				character = meta_matcher_spec[i];
-				if (character > 127) {
-					static_fail_with_msg("invalid character (not in ASCII range) present in matcher specification");
-				}
-
-				switch (character) {
-				case '|':
-					if (last_character != -1) {
-						// We only set callbacks here on purpose, this is the correct behavior for longest match.
-						string_matcher_with_indices.data[last_merge_row][last_character].callback = func_ptr_array[string_index];
-						character = -1;		// to make sure that empty strings don't mess up the system
-					}
-					string_index++;
-					merge_row_current = 0;
-					continue;
-				case '\\':
-					i++;
-					if (i == meta_matcher_spec.length) {
-						static_fail_with_msg("backslash ('\\') character cannot appear at end of matcher specification");
-					}
-
-					last_character = character;
-					character = meta_matcher_spec[i];
-					if (character > 127) {
-						static_fail_with_msg("invalid character (not in ASCII range) present in matcher specification");
-					}
-					// fallthrough
-				default:
-					// NOTE: Using chars as array subscript shouldn't be an issue since, while the character encoding
-					// is implementation defined, I believe the basic string literal character set is guaranteed to always be
-					// 0 or greater for every character. The user will probably be able to put in negative chars
-					// if they use some weird unicode strings for meta_matcher_spec, which is bad
-					// since negative subscripts are UB, so we check that each character is in the correct range and throw an
-					// error if it isn't.
-					// IMPORTANT: In doing so, we've converted char to unsigned char, making the negativity issue irrelevant.
-					// Still, I'm not allowing anything that isn't ASCII because I don't want to deal with unicode right now,
-					// although it could potentially be easy in this case.
-					// SIDE-NOTE: The reason negative subscripts are UB is because pointer overflow/underflow is UB. If the array
-					// happens to be at the start of memory (it won't be on most machines, but the spec needs to be
-					// compatible with that situation), then negative subscript will underflow the resulting pointer, so not allowed.
-					// This is also why moving a pointer outside of the bounds of an object (like an array or a class or something)
-					// is undefined (UNLESS you've only moved it one past the end of the object, the spec defines this
-					// because one-past-the-end pointers are useful, this also means that no object will be right at the end
-					// of memory because there still has to be space for the possible one-past-the-end pointer).
-					// Note that you don't even have to dereference it, simply moving it past the one-past-the-end or before the
-					// start of the object will result in UB.
-					// Thankfully (although I didn't explicitly find the following in the standard, it makes sense and is necessary
-					// for many applications), pointing a pointer to a specific position by value and moving it around there,
-					// even though there might not exist an object there, is probably fine, since you're avoiding pointer overflow.
-					// TODO: Research and find out what is different about pointers from unsigned integers.
-					// I always thought pointers were basically integers that you dereference, so why is overflow undefined for them?
-					string_matcher_with_indices_table_element_t& element = string_matcher_with_indices.data[merge_row_current][character];
-					if (element.next_state == 0) {
-						last_table_row = merge_row_current;	// in order to ensure the ending if's change the right row
-						element.next_state = table_row;
-						merge_row_current = 0;		// in order to make sure that the ending if's get triggered right
-						i++;
-						break;
-					}
-					last_merge_row = merge_row_current;
-					merge_row_current = element.next_state;
-					continue;
-				}
-				break;
-			}
-			if (i == meta_matcher_spec.length) { break; }		// NOTE: Again, necessary because consteval's don't allow goto.
-		}
-
-		if (character != -1) {
-			if (merge_row_current != 0) {
-				// We only set callbacks here on purpose, this is the correct behavior for longest match.
-				string_matcher_with_indices.data[last_merge_row][character].callback = func_ptr_array[string_index];
-			} else {
-				string_matcher_with_indices.data[last_table_row][character] = { 0, func_ptr_array[string_index] };
-			}
-			string_index++;
-		}
-
-		if (string_index != sizeof...(func_ptrs)) { static_fail_with_msg("failed to create string matcher, too many callbacks specified"); }
+		// NOTE: build_automaton did all the real work (see there, and build_automaton_for_table). What's left to do here is renumbering the
+		// states (see string_matcher_table_t) and copying everything into the result.
+		constexpr size_t no_match_id = match_count;
+		if (automaton.string_count != match_count) { static_fail_with_msg("internal error, calculate_string_count doesn't match the actual number of strings"); }
+		// NOTE: table_length is the automaton's state_count, so there's nothing to trim here.
+		if (automaton.state_count != table_length) { static_fail_with_msg("internal error, the table length doesn't match the automaton"); }
 
-		// NOTE: I wanted to trim the unused section of the string matcher table here, but that doesn't work because
-		// the length of the used part of the table isn't a constant expression and we have no way of getting it into a template
-		// parameter. (This makes sense given that the length of the used section is solely dependant on the func arg matcher_spec).
-		// No matter, we'll just do it outside of compile-time and rely on optimizations, which should almost definitely come.
+		write_string_matcher_table(meta_matcher_spec, class_count, no_match_id, table_length, automaton.transitions, automaton.match_ids, automaton.output_links, result);
 
-		result_pair.second = table_row;
+		return result;
+	}
 
-		return result_pair;
+	template <const const_string& meta_matcher_spec>
+	consteval auto create_string_matcher_table() {
+		static_assert(sizeof(char) == 1, "meta_string_match.h cannot be used on systems where char size is bigger than 1");
+		constexpr size_t character_count = calculate_table_length(meta_matcher_spec);
+		static_assert(character_count != 0, "failed to create string matcher, the resulting table length would be 0 (it would not match anything)");
+		constexpr size_t class_count = calculate_byte_class_count(meta_matcher_spec);
+		constexpr size_t string_count = calculate_string_count(meta_matcher_spec);
+		constexpr size_t longest_string_length = calculate_longest_string_length(meta_matcher_spec);
+		// NOTE: The automaton is built once, here, and the table gets it's length from it (see built_automaton_t).
+		constexpr auto automaton = build_automaton_for_table<calculate_state_capacity(meta_matcher_spec), class_count, string_count>(meta_matcher_spec);
+		return compile_to_table<automaton.state_count, class_count, string_count, longest_string_length>(meta_matcher_spec, automaton);
 	}
 
 	template <const const_string& meta_matcher_spec, typename... func_ret_types>
 	// NOTE: Rule of thumb for where the ... goes: before the variable name.
-	consteval auto inner_create_string_matcher_with_indices(func_ret_types (*...func_ptrs)(size_t)) {
-		constexpr size_t table_length = calculate_table_length(meta_matcher_spec);
-		static_assert(table_length != 0, "failed to create string matcher, the resulting table length would be 0 (it would not match anything)");
-		return compile_to_table<table_length>(meta_matcher_spec, func_ptrs...);
+	consteval auto inner_create_string_matcher_callbacks(func_ret_types (*...func_ptrs)(size_t)) {
+		static_assert(sizeof...(func_ptrs) != 0, "failed to create string matcher, no callbacks provided");
+		static_assert(sizeof...(func_ptrs) == calculate_string_count(meta_matcher_spec),
+			      "failed to create string matcher, number of callbacks doesn't match number of strings in matcher specification");
+		//func_ptr_array_wrapper_t<sizeof...(func_ptrs)> func_ptr_array = convert_func_ptr_pack_to_array(func_ptrs...);
+		// TODO: The above causes clang to bug out. Presumably same bug as the other spots where this happens. REPORT!!!!!
+		// TODO: This and the other bugs in this file might be totally gone now that I've updated my clang version, test that out!
+		func_ptr_array_wrapper_t<sizeof...(func_ptrs)> func_ptr_array;
+		func_ptr_array = convert_func_ptr_pack_to_array(func_ptrs...);
+		return func_ptr_array;
 	}
 
+	// NOTE: What the callbacks are when you don't give the macro any, see below.
+	inline void ignore_match(size_t) noexcept { }
+
+	// NOTE: No callbacks at all is fine too, for when you only use find_matches or lookup. Every string simply gets ignore_match then,
+	// so scan and match_character still work (and still count the matches), they just don't do anything else.
 	template <const const_string& meta_matcher_spec, typename... callback_types>
-	consteval auto create_string_matcher_with_indices(callback_types... callbacks) {
-		static_assert(sizeof(char) == 1, "meta_string_match.h cannot be used on systems where char size is bigger than 1");
-		return inner_create_string_matcher_with_indices<meta_matcher_spec>(((void(*)(size_t))callbacks)...);
+	consteval auto create_string_matcher_callbacks(callback_types... callbacks) {
+		if constexpr (sizeof...(callbacks) == 0) {
+			func_ptr_array_wrapper_t<calculate_string_count(meta_matcher_spec)> func_ptr_array;
+			for (size_t i = 0; i < calculate_string_count(meta_matcher_spec); i++) { func_ptr_array[i] = ignore_match; }
+			return func_ptr_array;
+		} else {
+			return inner_create_string_matcher_callbacks<meta_matcher_spec>(((void(*)(size_t))callbacks)...);
+		}
 	}
 
 // NOTE: ## concatinates the two C++ tokens to either side into one token. If the resulting token isn't valid, the whole expression is simply emitted.
@@ -522,26 +2404,41 @@ not even rely on SFINAE.
 // to make absolutely sure that nothing gets misunderstood.
 // Isn't it cool though that the preprocessor contains a lexer? In practice the preprocessor and lexer (as well as almost everything else)
 // are simply combined.
-#define CREATE_META_STRING_MATCHER(matcher_name, matcher_spec, ...) const auto matcher_name ## _INDICES_PLUS_LENGTH_VERSION_DO_NOT_TOUCH = []() { \
-static constexpr meta::const_string meta_matcher_spec = meta::const_string(matcher_spec); \
-/* static constexpr meta::const_string meta_matcher_spec(matcher_spec); <-- CLANG BUG!!!! CRASHES CLANG!!!! TODO: REPORT!!!!! */ \
-\
-constexpr auto string_matcher_with_indices_pair = meta::create_string_matcher_with_indices<meta_matcher_spec>(__VA_ARGS__); \
-\
-const auto result_pair = meta::create_pair_with_compile_time_second_t<string_matcher_with_indices_pair.second>(string_matcher_with_indices_pair.first); \
-\
-return result_pair; \
-}(); \
-\
-meta::string_matcher_t<decltype( matcher_name ## _INDICES_PLUS_LENGTH_VERSION_DO_NOT_TOUCH )::second> matcher_name; \
-\
-const void * const matcher_name ## _DUMMY_VARIABLE_DO_NOT_TOUCH = [](auto& matcher_name, auto& matcher_name ## _INDICES_PLUS_LENGTH_VERSION_DO_NOT_TOUCH ) { \
-for (std::size_t i = 0; i < std::remove_reference_t<decltype(matcher_name)>::length * meta::string_matcher_table_width; i++) { \
-if (( matcher_name ## _INDICES_PLUS_LENGTH_VERSION_DO_NOT_TOUCH ).first.data[0][i].next_state == 0) { matcher_name.data[0][i].next_state_ptr = nullptr; } \
-else { matcher_name.data[0][i].next_state_ptr = matcher_name.data[0] + ( matcher_name ## _INDICES_PLUS_LENGTH_VERSION_DO_NOT_TOUCH ).first.data[0][i].next_state * meta::string_matcher_table_width; } \
-matcher_name.data[0][i].callback = ( matcher_name ## _INDICES_PLUS_LENGTH_VERSION_DO_NOT_TOUCH ).first.data[0][i].callback; \
-} \
-return nullptr; \
-}(matcher_name, ( matcher_name ## _INDICES_PLUS_LENGTH_VERSION_DO_NOT_TOUCH )) \
+// NOTE: The table doesn't contain any pointers anymore, so the whole matcher comes straight out of compile-time. There used to be
+// a lambda here that converted indices into pointers at runtime, that's not necessary anymore.
+// The spec, the table and the callbacks are all static constexpr variables, the spec so that it can be passed as a template argument
+// (see create_string_matcher_table) and the other two so that they end up in read-only memory and can be passed as template arguments
+// to string_matcher_t. static also means that the table doesn't get copied onto the stack every time you enter the scope,
+// if you put the macro in a function.
+// IMPORTANT: The static constexpr variables are the reason why this macro only works in namespace scope and function scope.
+#define CREATE_META_STRING_MATCHER(matcher_name, matcher_spec, ...) static constexpr meta::const_string matcher_name ## _SPEC_DO_NOT_TOUCH = meta::const_string(matcher_spec); \
+/* static constexpr meta::const_string matcher_name ## _SPEC_DO_NOT_TOUCH(matcher_spec); <-- CLANG BUG!!!! CRASHES CLANG!!!! TODO: REPORT!!!!! */ \
+static constexpr auto matcher_name ## _TABLE_DO_NOT_TOUCH = meta::create_string_matcher_table< matcher_name ## _SPEC_DO_NOT_TOUCH >(); \
+static constexpr auto matcher_name ## _CALLBACKS_DO_NOT_TOUCH = meta::create_string_matcher_callbacks< matcher_name ## _SPEC_DO_NOT_TOUCH >(__VA_ARGS__); \
+meta::string_matcher_for_spec_t< matcher_name ## _SPEC_DO_NOT_TOUCH, matcher_name ## _TABLE_DO_NOT_TOUCH, matcher_name ## _CALLBACKS_DO_NOT_TOUCH > matcher_name
+
+// NOTE: Same as above, except that the matcher itself is declared constinit, which makes the compiler complain if it ever can't be
+// initialized at compile-time. Only works in namespace scope (or for static variables), because that's what constinit is restricted to.
+#define CREATE_CONSTINIT_META_STRING_MATCHER(matcher_name, matcher_spec, ...) static constexpr meta::const_string matcher_name ## _SPEC_DO_NOT_TOUCH = meta::const_string(matcher_spec); \
+static constexpr auto matcher_name ## _TABLE_DO_NOT_TOUCH = meta::create_string_matcher_table< matcher_name ## _SPEC_DO_NOT_TOUCH >(); \
+static constexpr auto matcher_name ## _CALLBACKS_DO_NOT_TOUCH = meta::create_string_matcher_callbacks< matcher_name ## _SPEC_DO_NOT_TOUCH >(__VA_ARGS__); \
+constinit meta::string_matcher_for_spec_t< matcher_name ## _SPEC_DO_NOT_TOUCH, matcher_name ## _TABLE_DO_NOT_TOUCH, matcher_name ## _CALLBACKS_DO_NOT_TOUCH > matcher_name
+
+// NOTE: Same as CREATE_META_STRING_MATCHER, except that the matcher counts what it does (see meta::string_matcher_stats_t),
+// which you get with matcher.stats_snapshot(). It's always the table matcher, whatever the flags say, because that's what the counters
+// are about (state_visit_counts is indexed by the table's states). Don't use this one in production, the counting isn't free.
+#define CREATE_META_STRING_MATCHER_WITH_STATS(matcher_name, matcher_spec, ...) static constexpr meta::const_string matcher_name ## _SPEC_DO_NOT_TOUCH = meta::const_string(matcher_spec); \
+static constexpr auto matcher_name ## _TABLE_DO_NOT_TOUCH = meta::create_string_matcher_table< matcher_name ## _SPEC_DO_NOT_TOUCH >(); \
+static constexpr auto matcher_name ## _CALLBACKS_DO_NOT_TOUCH = meta::create_string_matcher_callbacks< matcher_name ## _SPEC_DO_NOT_TOUCH >(__VA_ARGS__); \
+meta::string_matcher_t< matcher_name ## _TABLE_DO_NOT_TOUCH, matcher_name ## _CALLBACKS_DO_NOT_TOUCH, \
+			meta::string_matcher_stats_t<std::remove_cvref_t<decltype(matcher_name ## _TABLE_DO_NOT_TOUCH)>> > matcher_name
+
+// NOTE: Same as CREATE_META_STRING_MATCHER, except that the handlers are kept in the matcher instead of being turned into function pointers,
+// so they can capture things and get inlined, see string_matcher_with_handlers_t. There's no callbacks array.
+// IMPORTANT: The matcher is declared auto, because the handler types are part of it's type. If the handlers capture local variables,
+// the macro obviously has to be in function scope. The switch_dispatch flag doesn't do anything here, it's always the table.
+#define CREATE_META_STRING_MATCHER_WITH_HANDLERS(matcher_name, matcher_spec, ...) static constexpr meta::const_string matcher_name ## _SPEC_DO_NOT_TOUCH = meta::const_string(matcher_spec); \
+static constexpr auto matcher_name ## _TABLE_DO_NOT_TOUCH = meta::create_string_matcher_table< matcher_name ## _SPEC_DO_NOT_TOUCH >(); \
+auto matcher_name = meta::create_string_matcher_with_handlers< matcher_name ## _TABLE_DO_NOT_TOUCH >(__VA_ARGS__)
 
 }
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdlib>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "meta_string_match.h"
+
+// NOTE: This is in it's own header because it's POSIX-only and pulls in a bunch of system headers that the matcher itself doesn't need.
+
+namespace meta {
+
+	// NOTE: No exceptions in here (the whole thing is built with -fno-exceptions), so the file functions return one of these.
+	// If something goes wrong, errno is still set from the call that failed, so you can use strerror and friends to find out more.
+	enum class scan_file_status_t {
+		success,
+		open_failed,
+		stat_failed,
+		read_failed
+	};
+
+	// NOTE: The size of the buffer for the read fallback. Big enough that the syscall overhead doesn't matter, small enough to stay in L2.
+	// The buffer is page-aligned, which lets the kernel copy whole pages.
+	inline constexpr size_t scan_file_read_buffer_size = 1024 * 1024;
+	inline constexpr size_t scan_file_read_buffer_alignment = 4096;
+
+	/*
+	   NOTE: Scans the whole file behind file_descriptor (from it's current offset if it isn't mmapable, from the start if it is) with matcher,
+	   which can be a string matcher or a cursor. The matcher gets reset first, and the positions the callbacks get are file offsets either way:
+	   the read fallback starts counting at the offset it starts reading from (0 for pipes and such, which don't have one).
+	   If the file is a regular file, it simply gets mmapped and the mapping goes straight into scan, no copies at all, and the kernel
+	   is told that we're going to read it sequentially, so it reads ahead aggressively. If mmap isn't possible (pipes, sockets,
+	   terminals, some special files), the file gets read in big chunks into one aligned buffer instead, with the same readahead hint,
+	   and every chunk goes into scan right away. Either way, it's way faster than feeding std::cin.get() into match_character.
+	   match_count (if you pass it) gets the number of callbacks that were called, even if reading failed half way through.
+	   IMPORTANT: The file descriptor isn't closed, it's yours.
+	*/
+	template <typename matcher_t>
+	scan_file_status_t scan_file_descriptor(matcher_t& matcher, int file_descriptor, size_t* match_count = nullptr) noexcept {
+		matcher.full_reset();
+		size_t local_match_count = 0;
+		if (match_count) { *match_count = 0; }
+
+		struct stat file_info;
+		if (fstat(file_descriptor, &file_info) == -1) { return scan_file_status_t::stat_failed; }
+
+		if (S_ISREG(file_info.st_mode) && file_info.st_size > 0) {
+			const size_t file_size = file_info.st_size;
+			void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+			if (mapping != MAP_FAILED) {
+				madvise(mapping, file_size, MADV_SEQUENTIAL);
+				const char* data = (const char*)mapping;
+				local_match_count = matcher.scan(data, data + file_size);
+				munmap(mapping, file_size);
+				if (match_count) { *match_count = local_match_count; }
+				return scan_file_status_t::success;
+			}
+			// NOTE: If mmap fails for whatever reason, we simply try reading it normally.
+		}
+
+		// NOTE: Not every file supports this, doesn't matter if it fails.
+		posix_fadvise(file_descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+		// NOTE: lseek fails for pipes and such, they simply start at 0.
+		const off_t start_offset = lseek(file_descriptor, 0, SEEK_CUR);
+		if (start_offset > 0) { matcher.input_stream_position = start_offset; }
+
+		char* buffer = (char*)std::aligned_alloc(scan_file_read_buffer_alignment, scan_file_read_buffer_size);
+		if (!buffer) { return scan_file_status_t::read_failed; }
+
+		scan_file_status_t status = scan_file_status_t::success;
+		while (true) {
+			const ssize_t bytes_read = read(file_descriptor, buffer, scan_file_read_buffer_size);
+			if (bytes_read == 0) { break; }
+			if (bytes_read == -1) {
+				if (errno == EINTR) { continue; }
+				status = scan_file_status_t::read_failed;
+				break;
+			}
+			local_match_count += matcher.scan(buffer, buffer + bytes_read);
+		}
+
+		std::free(buffer);
+		if (match_count) { *match_count = local_match_count; }
+		return status;
+	}
+
+	// NOTE: Same as above, except that it opens (and closes) the file for you.
+	template <typename matcher_t>
+	scan_file_status_t scan_file(matcher_t& matcher, const char* file_path, size_t* match_count = nullptr) noexcept {
+		if (match_count) { *match_count = 0; }
+
+		int file_descriptor;
+		do { file_descriptor = open(file_path, O_RDONLY | O_CLOEXEC); } while (file_descriptor == -1 && errno == EINTR);
+		if (file_descriptor == -1) { return scan_file_status_t::open_failed; }
+
+		const scan_file_status_t status = scan_file_descriptor(matcher, file_descriptor, match_count);
+		// NOTE: Saving errno so that close doesn't overwrite the reason for the failure.
+		const int saved_errno = errno;
+		close(file_descriptor);
+		errno = saved_errno;
+		return status;
+	}
+
+	/*
+	   NOTE: A read-only mapping of a whole file. It's here for loading serialized runtime tables (see load_runtime_string_matcher_table in
+	   meta_string_match_runtime.h) straight out of the page cache, without reading them into a buffer first, which also means that every process
+	   that maps the same table file shares the same physical memory. mmap always gives us page-aligned memory, so the alignment that
+	   load_runtime_string_matcher_table wants is taken care of. Keep the mapped_file_t around for as long as the table is used.
+	   map returns false if it fails, with errno set from the call that failed (EINVAL for empty files, those can't be mapped).
+	*/
+	class mapped_file_t {
+	public:
+		const unsigned char* data = nullptr;
+		size_t size = 0;
+
+		mapped_file_t() = default;
+		mapped_file_t(const mapped_file_t&) = delete;
+		mapped_file_t& operator=(const mapped_file_t&) = delete;
+		~mapped_file_t() { unmap(); }
+
+		bool map(const char* file_path) noexcept {
+			unmap();
+
+			int file_descriptor;
+			do { file_descriptor = open(file_path, O_RDONLY | O_CLOEXEC); } while (file_descriptor == -1 && errno == EINTR);
+			if (file_descriptor == -1) { return false; }
+
+			struct stat file_info;
+			void* mapping = MAP_FAILED;
+			if (fstat(file_descriptor, &file_info) != -1) {
+				if (file_info.st_size > 0) {
+					mapping = mmap(nullptr, file_info.st_size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+				} else {
+					errno = EINVAL;
+				}
+			}
+
+			// NOTE: The mapping stays valid after the file descriptor is closed. Saving errno so that close doesn't overwrite the reason for the failure.
+			const int saved_errno = errno;
+			close(file_descriptor);
+			errno = saved_errno;
+			if (mapping == MAP_FAILED) { return false; }
+
+			data = (const unsigned char*)mapping;
+			size = file_info.st_size;
+			return true;
+		}
+
+		void unmap() noexcept {
+			if (!data) { return; }
+			munmap((void*)data, size);
+			data = nullptr;
+			size = 0;
+		}
+
+		std::span<const unsigned char> bytes() const noexcept { return { data, size }; }
+	};
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+
+#include "meta_string_match.h"
+
+// NOTE: This is in it's own header so that you don't have to pull <thread> and <vector> into everything that uses a string matcher.
+
+namespace meta {
+
+	struct parallel_scan_match_t {
+		size_t match_id;
+		size_t position;
+	};
+
+	/*
+	   NOTE: Splits the buffer into thread_count chunks and scans them all at the same time, one thread per chunk (the calling thread takes
+	   the last one). The result is exactly the same as scanning the whole buffer in one go: match_handler gets called for every match,
+	   in stream order, with the same positions, and state and input_stream_position end up where they would have ended up.
+	   The problem with chunks is the matches that straddle the boundaries. The way around that is simple: every chunk except the first one
+	   starts scanning longest_match_length - 1 characters before it's actual beginning, from the root, and ignores the matches that end
+	   before it's actual beginning (the chunk before it reports those). The state of the table only depends on the last longest_match_length
+	   characters (nothing longer than that can be going on), so from it's actual beginning onwards, the chunk is in exactly the
+	   state it would have been in if we had scanned everything from the start.
+	   The first chunk starts from the state that's passed in, so you can use this in the middle of a stream too. Same goes for any chunk
+	   whose early start would reach back past the beginning of the buffer (that only happens if the chunks are tiny).
+	   IMPORTANT: The threads collect their matches first and match_handler only gets called from the calling thread, after all the threads
+	   are done. That's what keeps the matches in order, but it also means that a buffer with a ridiculous amount of matches is going to
+	   use a lot of memory. match_handler doesn't have to be thread-safe.
+	   Returns the number of matches.
+	*/
+	template <typename table_t, typename match_handler_t>
+	size_t parallel_scan(const table_t& table, size_t& state, size_t& input_stream_position, const char* begin, const char* end,
+			     size_t thread_count, match_handler_t&& match_handler) {
+		const size_t buffer_size = end - begin;
+
+		// NOTE: Threads are expensive to start, so it doesn't make sense to give them less than a couple pages each.
+		constexpr size_t minimum_chunk_size = 64 * 1024;
+		if (thread_count == 0) { thread_count = std::thread::hardware_concurrency(); }
+		if (thread_count > buffer_size / minimum_chunk_size) { thread_count = buffer_size / minimum_chunk_size; }
+		if (thread_count <= 1) { return table.scan(state, input_stream_position, begin, end, match_handler); }
+
+		const size_t overlap = table.longest_match_length - 1;
+		const size_t chunk_size = buffer_size / thread_count;
+		const size_t initial_state = state;
+		const size_t initial_input_stream_position = input_stream_position;
+
+		std::vector<std::vector<parallel_scan_match_t>> chunk_matches(thread_count);
+		std::vector<size_t> chunk_end_states(thread_count);
+
+		auto scan_chunk = [&](size_t chunk_index) {
+			const char* chunk_begin = begin + chunk_index * chunk_size;
+			const char* chunk_end = chunk_index == thread_count - 1 ? end : chunk_begin + chunk_size;
+
+			const char* scan_begin = chunk_begin;
+			size_t chunk_state = initial_state;
+			if (chunk_index != 0) {
+				scan_begin = (size_t)(chunk_begin - begin) > overlap ? chunk_begin - overlap : begin;
+				if (scan_begin != begin) { chunk_state = 0; }
+			}
+
+			const size_t chunk_input_stream_position = initial_input_stream_position + (chunk_begin - begin);
+			size_t scan_input_stream_position = initial_input_stream_position + (scan_begin - begin);
+			std::vector<parallel_scan_match_t>& matches = chunk_matches[chunk_index];
+			table.scan(chunk_state, scan_input_stream_position, scan_begin, chunk_end, [&](size_t match_id, size_t position) {
+				if (position >= chunk_input_stream_position) { matches.push_back({ match_id, position }); }
+			});
+			chunk_end_states[chunk_index] = chunk_state;
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count - 1);
+		for (size_t chunk_index = 0; chunk_index < thread_count - 1; chunk_index++) { threads.emplace_back(scan_chunk, chunk_index); }
+		scan_chunk(thread_count - 1);
+		for (std::thread& thread : threads) { thread.join(); }
+
+		size_t match_count = 0;
+		for (const std::vector<parallel_scan_match_t>& matches : chunk_matches) {
+			for (const parallel_scan_match_t& match : matches) { match_handler(match.match_id, match.position); }
+			match_count += matches.size();
+		}
+
+		state = chunk_end_states[thread_count - 1];
+		input_stream_position = initial_input_stream_position + buffer_size;
+		return match_count;
+	}
+
+	// NOTE: Same as string_matcher_t::scan, except in parallel. thread_count 0 means one thread per core.
+	// The stats of a matcher with stats (see string_matcher_stats_t) aren't counted here.
+	template <const auto& table, const auto& callbacks, typename stats_t>
+	size_t parallel_scan(string_matcher_t<table, callbacks, stats_t>& matcher, const char* begin, const char* end, size_t thread_count = 0) {
+		return parallel_scan(table, matcher.state, matcher.input_stream_position, begin, end, thread_count,
+				     [](size_t match_id, size_t position) { callbacks[match_id](position); });
+	}
+
+	template <typename table_t, typename callbacks_t>
+	size_t parallel_scan(string_matcher_cursor_t<table_t, callbacks_t>& cursor, const char* begin, const char* end, size_t thread_count = 0) {
+		return parallel_scan(*cursor.table, cursor.state, cursor.input_stream_position, begin, end, thread_count,
+				     [&cursor](size_t match_id, size_t position) { (*cursor.callbacks)[match_id](position); });
+	}
+
+	// NOTE: The bit-parallel matcher goes through the table, it's states convert to the table's and back, see string_matcher_bit_parallel_t.
+	template <const const_string& meta_matcher_spec, const auto& table, const auto& callbacks>
+	size_t parallel_scan(string_matcher_bit_parallel_t<meta_matcher_spec, table, callbacks>& matcher, const char* begin, const char* end, size_t thread_count = 0) {
+		string_matcher_stream_state_t stream_state = matcher.save_stream_state();
+		const size_t match_count = parallel_scan(table, stream_state.state, stream_state.input_stream_position, begin, end, thread_count,
+							 [](size_t match_id, size_t position) { callbacks[match_id](position); });
+		matcher.restore_stream_state(stream_state);
+		return match_count;
+	}
+
+	template <typename matcher_t>
+	size_t parallel_scan(matcher_t& matcher, std::span<const char> buffer, size_t thread_count = 0) {
+		return parallel_scan(matcher, buffer.data(), buffer.data() + buffer.size(), thread_count);
+	}
+
+}
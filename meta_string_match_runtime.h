@@ -0,0 +1,302 @@
+#pragma once
+
+#include <cstring>
+
+#include "meta_string_match.h"
+
+// NOTE: This is in it's own header because most of the time, the spec is a string literal and none of this is needed.
+
+namespace meta {
+
+	/*
+	   NOTE: Runtime tables are for specs that aren't known at compile-time (keyword lists from config files and such). They're built by the
+	   exact same code as the compile-time tables (build_automaton and write_string_matcher_table, which are constexpr instead of consteval
+	   for exactly this reason), they're interpreted by the exact same code too (basic_string_matcher_table_t), and they come out exactly the
+	   same, element for element. The only difference is where they live: a runtime table is one contiguous blob of memory, which starts
+	   with the header below and continues with data, match_ids, output_links and match_lengths, in that order, all of them arrays of state_t.
+	   That blob is also the serialized form of the table, so writing a table to a file is simply writing the blob (see serialized_table), and
+	   loading one is checking it and pointing the table at it, no copying (see load_runtime_string_matcher_table). Big pattern sets can be
+	   built once, offline, and then mmapped at startup by every process that needs them (see mapped_file_t in meta_string_match_file.h),
+	   and the page cache shares them between all of them.
+	   IMPORTANT: The blob is in the native byte order and layout, it's meant to be built by the same kind of machine that uses it (in a build
+	   step, for example). A blob from a machine with the other byte order gets rejected, because the format version doesn't match anymore.
+	   NOTE: Unlike the compile-time tables, which pick the smallest type for every array separately, a runtime table uses state_t for all
+	   of them, because the type has to be picked before we know what's in the spec. uint32_t is enough for anything you can build
+	   in a reasonable amount of time, uint16_t halves the size for small specs (the build fails if the table doesn't fit).
+	*/
+	struct runtime_string_matcher_table_header_t {
+		char magic[8];
+		uint32_t format_version;
+		uint32_t element_size;
+		uint64_t length;
+		uint64_t class_count;
+		uint64_t match_count;
+		uint64_t longest_match_length;
+		uint64_t first_accepting_state;
+		uint64_t max_matches_per_character;
+		uint64_t first_byte_count;
+		unsigned char first_bytes[string_matcher_prefilter_max_first_byte_count];
+		unsigned char byte_classes[string_matcher_character_count];
+	};
+
+	inline constexpr char runtime_string_matcher_table_magic[8] = { 'M', 'E', 'T', 'A', 'S', 'M', 'T', 'B' };
+	inline constexpr uint32_t runtime_string_matcher_table_format_version = 1;
+
+	// NOTE: The arrays come right after the header, so the header has to keep them aligned.
+	static_assert(sizeof(runtime_string_matcher_table_header_t) % alignof(uint64_t) == 0, "runtime string matcher table header breaks the alignment of the arrays");
+
+	/*
+	   NOTE: The storage for basic_string_matcher_table_t that has everything behind pointers into the blob. The table either owns the blob
+	   (when it was built at runtime) or simply looks at it (when it was loaded from somewhere, the memory has to stay around for as long as
+	   the table is used then). That's why it can be moved but not copied.
+	   IMPORTANT: A default constructed table is empty, only use it after build_runtime_string_matcher_table or
+	   load_runtime_string_matcher_table returned true.
+	*/
+	template <typename template_state_t>
+	class runtime_string_matcher_table_storage_t {
+	public:
+		using state_t = template_state_t;
+		using match_id_t = template_state_t;
+		using match_length_t = template_state_t;
+
+		size_t length = 0;
+		size_t class_count = 0;
+		size_t match_count = 0;
+		size_t longest_match_length = 0;
+
+		const unsigned char* byte_classes = nullptr;
+		const state_t* data = nullptr;
+		size_t first_accepting_state = 0;
+		const match_id_t* match_ids = nullptr;
+		const state_t* output_links = nullptr;
+		const match_length_t* match_lengths = nullptr;
+		size_t max_matches_per_character = 0;
+		size_t first_byte_count = 0;
+		const unsigned char* first_bytes = nullptr;
+
+		const unsigned char* blob = nullptr;
+		size_t blob_size = 0;
+		unsigned char* owned_blob = nullptr;
+
+		constexpr runtime_string_matcher_table_storage_t() = default;
+		runtime_string_matcher_table_storage_t(const runtime_string_matcher_table_storage_t&) = delete;
+		runtime_string_matcher_table_storage_t& operator=(const runtime_string_matcher_table_storage_t&) = delete;
+
+		runtime_string_matcher_table_storage_t(runtime_string_matcher_table_storage_t&& other) noexcept { *this = static_cast<runtime_string_matcher_table_storage_t&&>(other); }
+
+		runtime_string_matcher_table_storage_t& operator=(runtime_string_matcher_table_storage_t&& other) noexcept {
+			if (this == &other) { return *this; }
+			delete[] owned_blob;
+			owned_blob = other.owned_blob;
+			other.owned_blob = nullptr;
+			attach(other.blob, other.blob_size);
+			other.attach(nullptr, 0);
+			return *this;
+		}
+
+		~runtime_string_matcher_table_storage_t() { delete[] owned_blob; }
+
+		// NOTE: The serialized form of the table, write it wherever you want and load it with load_runtime_string_matcher_table.
+		std::span<const unsigned char> serialized_table() const noexcept { return { blob, blob_size }; }
+
+		static constexpr size_t calculate_blob_size(size_t length, size_t class_count, size_t match_count) noexcept {
+			return sizeof(runtime_string_matcher_table_header_t) + (length * class_count + length * 2 + match_count) * sizeof(state_t);
+		}
+
+		// NOTE: Points everything at the blob (or at nothing, if it's null). Doesn't check anything, that's load_runtime_string_matcher_table's job.
+		// Doesn't touch owned_blob either.
+		void attach(const unsigned char* new_blob, size_t new_blob_size) noexcept {
+			blob = new_blob;
+			blob_size = new_blob_size;
+			if (!blob) {
+				length = class_count = match_count = longest_match_length = 0;
+				first_accepting_state = max_matches_per_character = first_byte_count = 0;
+				byte_classes = first_bytes = nullptr;
+				data = output_links = nullptr;
+				match_ids = match_lengths = nullptr;
+				return;
+			}
+
+			const runtime_string_matcher_table_header_t* header = (const runtime_string_matcher_table_header_t*)blob;
+			length = header->length;
+			class_count = header->class_count;
+			match_count = header->match_count;
+			longest_match_length = header->longest_match_length;
+			byte_classes = header->byte_classes;
+			first_accepting_state = header->first_accepting_state;
+			max_matches_per_character = header->max_matches_per_character;
+			first_byte_count = header->first_byte_count;
+			first_bytes = header->first_bytes;
+
+			data = (const state_t*)(blob + sizeof(runtime_string_matcher_table_header_t));
+			match_ids = data + length * class_count;
+			output_links = match_ids + length;
+			match_lengths = output_links + length;
+		}
+
+	};
+
+	template <typename state_t = uint32_t>
+	using runtime_string_matcher_table_t = basic_string_matcher_table_t<runtime_string_matcher_table_storage_t<state_t>>;
+
+	// NOTE: What write_string_matcher_table writes into for a runtime table, the same names as in the storage, only writable.
+	template <typename state_t>
+	struct runtime_string_matcher_table_writer_t {
+		unsigned char* byte_classes;
+		state_t* data;
+		size_t first_accepting_state;
+		state_t* match_ids;
+		state_t* output_links;
+		state_t* match_lengths;
+		size_t max_matches_per_character;
+		size_t first_byte_count;
+		unsigned char* first_bytes;
+	};
+
+	inline bool fail_runtime_string_matcher_table(const char** error_message, const char* message) noexcept {
+		if (error_message) { *error_message = message; }
+		return false;
+	}
+
+	/*
+	   NOTE: Builds the table for a spec that's only known at runtime. The spec means exactly what it means in CREATE_META_STRING_MATCHER
+	   (flags included, make the const_string with the (data, length, flags) constructor), and the table is the same one the macro would make.
+	   There are no exceptions in here, so if something is wrong with the spec (or the table doesn't fit into state_t), it returns false,
+	   leaves result alone and puts the reason into error_message (if you pass it), which is the same message you'd get
+	   as a compile error for the same spec.
+	   The callbacks are up to you: the table works with string_matcher_cursor_t like every other table, with any callbacks_t that can be
+	   indexed by match id (an array or a std::vector of function pointers, for example). Or use find_matches and lookup, those don't need any.
+	*/
+	template <typename state_t>
+	bool build_runtime_string_matcher_table(const const_string& meta_matcher_spec, runtime_string_matcher_table_t<state_t>& result,
+						const char** error_message = nullptr) noexcept {
+		string_matcher_spec_error = nullptr;
+		const size_t character_count = calculate_table_length(meta_matcher_spec);
+		if (string_matcher_spec_error) { return fail_runtime_string_matcher_table(error_message, string_matcher_spec_error); }
+		if (character_count == 0) {
+			return fail_runtime_string_matcher_table(error_message, "failed to create string matcher, the resulting table length would be 0 (it would not match anything)");
+		}
+
+		unsigned char byte_classes[string_matcher_character_count];
+		const size_t class_count = calculate_byte_classes(meta_matcher_spec, byte_classes);
+		const size_t match_count = calculate_string_count(meta_matcher_spec);
+		const size_t longest_match_length = calculate_longest_string_length(meta_matcher_spec);
+
+		const size_t no_match_id = match_count;
+		compile_time_array_t<size_t> transitions;
+		compile_time_array_t<size_t> automaton_match_ids;
+		compile_time_array_t<size_t> automaton_output_links;
+		build_automaton(meta_matcher_spec, byte_classes, class_count, no_match_id, transitions, automaton_match_ids, automaton_output_links);
+		const size_t length = automaton_match_ids.size;
+
+		constexpr size_t max_element_value = (state_t)-1;
+		if ((length - 1) * class_count > max_element_value || match_count - 1 > max_element_value || longest_match_length > max_element_value) {
+			return fail_runtime_string_matcher_table(error_message, "failed to create string matcher, the table doesn't fit into state_t, use a bigger one");
+		}
+
+		const size_t blob_size = runtime_string_matcher_table_storage_t<state_t>::calculate_blob_size(length, class_count, match_count);
+		// NOTE: The () zeroes it, write_string_matcher_table relies on that. new[] gives us memory that's aligned for anything.
+		unsigned char* blob = new unsigned char[blob_size]();
+		runtime_string_matcher_table_header_t* header = (runtime_string_matcher_table_header_t*)blob;
+		std::memcpy(header->magic, runtime_string_matcher_table_magic, sizeof(header->magic));
+		header->format_version = runtime_string_matcher_table_format_version;
+		header->element_size = sizeof(state_t);
+		header->length = length;
+		header->class_count = class_count;
+		header->match_count = match_count;
+		header->longest_match_length = longest_match_length;
+		std::memcpy(header->byte_classes, byte_classes, sizeof(byte_classes));
+
+		state_t* data = (state_t*)(blob + sizeof(runtime_string_matcher_table_header_t));
+		runtime_string_matcher_table_writer_t<state_t> writer { header->byte_classes, data, 0, data + length * class_count, data + length * class_count + length,
+									 data + length * class_count + length * 2, 0, 0, header->first_bytes };
+		write_string_matcher_table(meta_matcher_spec, class_count, no_match_id, length, transitions, automaton_match_ids, automaton_output_links, writer);
+		header->first_accepting_state = writer.first_accepting_state;
+		header->max_matches_per_character = writer.max_matches_per_character;
+		header->first_byte_count = writer.first_byte_count;
+
+		result = runtime_string_matcher_table_t<state_t>();
+		result.owned_blob = blob;
+		result.attach(blob, blob_size);
+		return true;
+	}
+
+	/*
+	   NOTE: Points result at a serialized table (see serialized_table), without copying it, so serialized_table has to stay where it is for
+	   as long as result is used. It has to be aligned to 8 bytes (mmap and new[] always are).
+	   The blob could come from anywhere (a file that's been truncated, tampered with or written by some other version), so it gets checked
+	   completely before it's used: every element has to be a valid state, every output chain has to end within max_matches_per_character
+	   steps, and so on. That's one pass over the table, which is nothing compared to building it. If anything is off, it returns false,
+	   leaves result alone and puts the reason into error_message (if you pass it).
+	*/
+	template <typename state_t>
+	bool load_runtime_string_matcher_table(std::span<const unsigned char> serialized_table, runtime_string_matcher_table_t<state_t>& result,
+					       const char** error_message = nullptr) noexcept {
+		using storage_t = runtime_string_matcher_table_storage_t<state_t>;
+
+		if ((uintptr_t)serialized_table.data() % alignof(uint64_t) != 0) { return fail_runtime_string_matcher_table(error_message, "serialized table isn't aligned to 8 bytes"); }
+		if (serialized_table.size() < sizeof(runtime_string_matcher_table_header_t)) { return fail_runtime_string_matcher_table(error_message, "serialized table is truncated"); }
+
+		const runtime_string_matcher_table_header_t* header = (const runtime_string_matcher_table_header_t*)serialized_table.data();
+		if (std::memcmp(header->magic, runtime_string_matcher_table_magic, sizeof(header->magic)) != 0) {
+			return fail_runtime_string_matcher_table(error_message, "not a serialized string matcher table");
+		}
+		if (header->format_version != runtime_string_matcher_table_format_version) {
+			return fail_runtime_string_matcher_table(error_message, "serialized table has the wrong format version (or byte order)");
+		}
+		if (header->element_size != sizeof(state_t)) { return fail_runtime_string_matcher_table(error_message, "serialized table was built with a different state_t"); }
+
+		const size_t length = header->length;
+		const size_t class_count = header->class_count;
+		const size_t match_count = header->match_count;
+		if (length == 0 || class_count == 0 || class_count > string_matcher_character_count || match_count == 0) {
+			return fail_runtime_string_matcher_table(error_message, "serialized table has invalid dimensions");
+		}
+		// NOTE: Checking for overflow before calculating the size. Every element is at least a byte, so none of this can be bigger than the blob.
+		if (length > serialized_table.size() / class_count || match_count > serialized_table.size() ||
+		    serialized_table.size() != storage_t::calculate_blob_size(length, class_count, match_count)) {
+			return fail_runtime_string_matcher_table(error_message, "serialized table has the wrong size");
+		}
+
+		storage_t view;
+		view.attach(serialized_table.data(), serialized_table.size());
+		const size_t state_end = length * class_count;
+		const auto is_valid_state = [&](size_t state) { return state < state_end && state % class_count == 0; };
+
+		for (size_t character = 0; character < string_matcher_character_count; character++) {
+			if (view.byte_classes[character] >= class_count) { return fail_runtime_string_matcher_table(error_message, "serialized table has an invalid byte class"); }
+		}
+		for (size_t i = 0; i < state_end; i++) {
+			if (!is_valid_state(view.data[i])) { return fail_runtime_string_matcher_table(error_message, "serialized table has an invalid element"); }
+		}
+		if (view.first_accepting_state == 0 || !is_valid_state(view.first_accepting_state) || view.max_matches_per_character == 0) {
+			return fail_runtime_string_matcher_table(error_message, "serialized table has invalid accepting states");
+		}
+		for (size_t match_id = 0; match_id < match_count; match_id++) {
+			if (view.match_lengths[match_id] > view.longest_match_length) { return fail_runtime_string_matcher_table(error_message, "serialized table has an invalid string length"); }
+		}
+		for (size_t state = view.first_accepting_state; state < state_end; state += class_count) {
+			size_t chain_length = 0;
+			for (size_t output_state = state; output_state != 0; output_state = view.output_links[output_state / class_count]) {
+				if (!is_valid_state(output_state) || output_state < view.first_accepting_state || view.match_ids[output_state / class_count] >= match_count ||
+				    ++chain_length > view.max_matches_per_character) {
+					return fail_runtime_string_matcher_table(error_message, "serialized table has an invalid output chain");
+				}
+			}
+		}
+
+		// NOTE: A wrong prefilter wouldn't crash anything, it'd silently skip matches, so it's simply compared with what it has to be.
+		size_t first_byte_count = 0;
+		for (size_t character = 0; character < string_matcher_character_count; character++) {
+			if (view.data[view.byte_classes[character]] == 0) { continue; }
+			if (first_byte_count < string_matcher_prefilter_max_first_byte_count && view.first_bytes[first_byte_count] != character) { first_byte_count = (size_t)-1; break; }
+			first_byte_count++;
+		}
+		if (first_byte_count != view.first_byte_count) { return fail_runtime_string_matcher_table(error_message, "serialized table has an invalid prefilter"); }
+
+		result = runtime_string_matcher_table_t<state_t>();
+		result.attach(serialized_table.data(), serialized_table.size());
+		return true;
+	}
+
+}
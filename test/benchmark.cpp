@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "meta_string_match.h"
+
+using size_t = std::size_t;
+
+/*
+   NOTE: Throughput benchmark for the string matcher and the stuff we'd otherwise use instead (a std::string_view::find loop per string,
+   and one std::regex with all the strings as alternatives). Everything is generated in here, so there's nothing to download:
+   random bytes, log-like text and, for every matcher, a worst case made of nothing but it's own strings back to back.
+   Run it with make benchmark, that also measures how long every matcher takes to compile (see BENCHMARK_COMPILE_TIME_MATCHER below)
+   and passes the file with the results as the first argument. Without the argument, the compile time column is simply empty.
+   NOTE: The matcher reports every match, overlapping ones included, and so does the find loop (it restarts one character after every
+   match), so their match counts have to be the same, which makes this a test too. std::regex can't do overlapping matches, so
+   it's count is lower, and it's so slow that it only gets a small piece of every corpus (the per-byte numbers are still comparable).
+*/
+
+// NOTE: Random lowercase words, separated by |, so a spec for a matcher. Generated at compile-time so we can have big specs
+// without typing them out. The generator is xorshift64, it only has to look random, not be random.
+template <size_t word_count, size_t word_length, uint64_t seed>
+struct generated_spec_t {
+	static constexpr size_t length = word_count * (word_length + 1) - 1;
+	char data[length + 1];
+
+	constexpr generated_spec_t() : data { } {
+		uint64_t random_state = seed;
+		for (size_t i = 0; i < length; i++) {
+			if (i % (word_length + 1) == word_length) {
+				data[i] = '|';
+				continue;
+			}
+			random_state ^= random_state << 13;
+			random_state ^= random_state >> 7;
+			random_state ^= random_state << 17;
+			data[i] = 'a' + random_state % 26;
+		}
+	}
+};
+
+template <size_t word_count, size_t word_length, uint64_t seed>
+inline constexpr generated_spec_t<word_count, word_length, seed> generated_spec;
+
+#define GENERATED_SPEC(word_count, word_length) meta::const_string(generated_spec<word_count, word_length, word_count * 1000 + word_length>.data, \
+								   generated_spec_t<word_count, word_length, word_count * 1000 + word_length>::length)
+
+/*
+   NOTE: make benchmark compiles this file once per matcher with BENCHMARK_COMPILE_TIME_MATCHER set to the index of the matcher,
+   and only that matcher in it, to see how long the compiler takes for it. All the runtime stuff is left out then.
+   It's also compiled once with BENCHMARK_COMPILE_TIME_MATCHER set to -1, which leaves out every matcher, and that time
+   (parsing the headers and so on) gets subtracted from the others.
+   IMPORTANT: The indices here have to match BENCHMARK_MATCHER_INDICES in the makefile.
+   NOTE: Much bigger than words_128x12 (512 strings of 12 characters, for example) runs into GCC's default constexpr operation limit,
+   see -fconstexpr-ops-limit (clang has -fconstexpr-steps).
+*/
+#ifdef BENCHMARK_COMPILE_TIME_MATCHER
+#define BENCHMARK_HAS_MATCHER(index) (BENCHMARK_COMPILE_TIME_MATCHER == index)
+#else
+#define BENCHMARK_HAS_MATCHER(index) 1
+#endif
+
+#if BENCHMARK_HAS_MATCHER(0)
+CREATE_META_STRING_MATCHER(log_keywords, "ERROR|WARN|INFO|DEBUG|GET|POST|DELETE|timeout|refused|/api/v1/|admin");
+#endif
+#if BENCHMARK_HAS_MATCHER(1)
+CREATE_META_STRING_MATCHER(words_8x4, GENERATED_SPEC(8, 4));
+#endif
+#if BENCHMARK_HAS_MATCHER(2)
+CREATE_META_STRING_MATCHER(words_8x16, GENERATED_SPEC(8, 16));
+#endif
+#if BENCHMARK_HAS_MATCHER(3)
+CREATE_META_STRING_MATCHER(words_64x8, GENERATED_SPEC(64, 8));
+#endif
+#if BENCHMARK_HAS_MATCHER(4)
+CREATE_META_STRING_MATCHER(words_256x6, GENERATED_SPEC(256, 6));
+#endif
+#if BENCHMARK_HAS_MATCHER(5)
+CREATE_META_STRING_MATCHER(words_128x12, GENERATED_SPEC(128, 12));
+#endif
+
+#ifndef BENCHMARK_COMPILE_TIME_MATCHER
+
+// NOTE: Big enough to not fit in any cache, small enough to not take forever.
+constexpr size_t corpus_size = 16 * 1024 * 1024;
+constexpr size_t regex_corpus_size = 256 * 1024;
+// NOTE: The find loop goes over the corpus once per string, so it gets way too slow for the big specs.
+constexpr size_t find_loop_max_string_count = 64;
+constexpr size_t repetition_count = 3;
+
+struct corpus_t {
+	const char* name;
+	std::string data;
+};
+
+uint64_t random_state = 0x9e3779b97f4a7c15;
+
+uint64_t next_random() noexcept {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return random_state;
+}
+
+std::string generate_random_bytes() {
+	std::string result(corpus_size, '\0');
+	for (char& character : result) { character = (char)next_random(); }
+	return result;
+}
+
+// NOTE: Looks roughly like an access log with a bit of application logging mixed in, which is the kind of thing we'd be scanning.
+std::string generate_log_text() {
+	static const char* const levels[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR" };
+	static const char* const methods[] = { "GET", "GET", "GET", "POST", "PUT", "DELETE" };
+	static const char* const paths[] = { "/api/v1/users/", "/api/v1/orders/", "/static/img/", "/health", "/login?next=/admin/", "/api/v2/search?q=" };
+	static const char* const messages[] = { "request served", "connection refused by upstream", "cache miss", "upstream timeout after 30s",
+						"slow query", "retrying" };
+
+	std::string result;
+	result.reserve(corpus_size + 256);
+	char line[256];
+	while (result.size() < corpus_size) {
+		const uint64_t random = next_random();
+		const int line_length = std::snprintf(line, sizeof(line), "2026-10-%02u %02u:%02u:%02u.%03u %-5s [worker-%u] %s %s%u %u %ums %s\n",
+			(unsigned)(random % 28 + 1), (unsigned)(random >> 5) % 24, (unsigned)(random >> 10) % 60, (unsigned)(random >> 16) % 60,
+			(unsigned)(random >> 22) % 1000, levels[(random >> 32) % 6], (unsigned)(random >> 35) % 16, methods[(random >> 40) % 6],
+			paths[(random >> 43) % 6], (unsigned)(random >> 46) % 100000, (random >> 60) % 8 == 0 ? 404u : 200u,
+			(unsigned)(random >> 50) % 2000, messages[(random >> 61) % 6]);
+		result.append(line, line_length);
+	}
+	result.resize(corpus_size);
+	return result;
+}
+
+std::vector<std::string_view> split_spec(const meta::const_string& spec) {
+	// NOTE: The specs in here don't have any escapes or flags, so splitting at | is all there is to it.
+	std::vector<std::string_view> result;
+	const std::string_view spec_view(spec.data, spec.length);
+	for (size_t begin = 0; begin <= spec_view.size(); ) {
+		const size_t end = std::min(spec_view.find('|', begin), spec_view.size());
+		if (end != begin) { result.push_back(spec_view.substr(begin, end - begin)); }
+		begin = end + 1;
+	}
+	return result;
+}
+
+// NOTE: The dense worst case: nothing but the matcher's own strings, so the matcher never gets to sit in the root, the prefilter
+// never gets to skip anything and there's a match every couple characters.
+std::string generate_dense_text(const std::vector<std::string_view>& strings) {
+	std::string result;
+	result.reserve(corpus_size + 256);
+	while (result.size() < corpus_size) { result += strings[next_random() % strings.size()]; }
+	result.resize(corpus_size);
+	return result;
+}
+
+std::string escape_for_regex(std::string_view string) {
+	std::string result;
+	for (char character : string) {
+		if (std::strchr("\\^$.|?*+()[]{}", character) != nullptr) { result += '\\'; }
+		result += character;
+	}
+	return result;
+}
+
+// NOTE: Runs the function repetition_count times and returns the fastest run in seconds (and what it returned, which is the match count).
+template <typename function_t>
+double measure(function_t&& function, size_t& match_count) {
+	double best_seconds = 1e300;
+	for (size_t repetition = 0; repetition < repetition_count; repetition++) {
+		const auto start = std::chrono::steady_clock::now();
+		match_count = function();
+		const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+		best_seconds = std::min(best_seconds, seconds.count());
+	}
+	return best_seconds;
+}
+
+void print_result(const char* corpus_name, const char* matcher_name, const char* engine_name, size_t byte_count, double seconds, size_t match_count) {
+	std::printf("%-12s %-14s %-12s %9.3f %9.3f %14.0f %12zu\n", corpus_name, matcher_name, engine_name,
+		    byte_count / seconds / 1e9, seconds * 1e9 / byte_count, match_count / seconds, match_count);
+}
+
+// NOTE: One line per matcher from the file make benchmark writes ("<matcher index> <milliseconds>"), or nothing if there isn't one.
+std::vector<double> read_compile_times(const char* path) {
+	std::vector<double> result;
+	FILE* file = path != nullptr ? std::fopen(path, "r") : nullptr;
+	if (file == nullptr) { return result; }
+	size_t matcher_index;
+	double milliseconds;
+	while (std::fscanf(file, "%zu %lf", &matcher_index, &milliseconds) == 2) {
+		if (matcher_index >= result.size()) { result.resize(matcher_index + 1, -1); }
+		result[matcher_index] = milliseconds;
+	}
+	std::fclose(file);
+	return result;
+}
+
+template <typename matcher_t>
+void benchmark_matcher(const char* matcher_name, size_t matcher_index, matcher_t& matcher, const meta::const_string& spec,
+		       const std::vector<corpus_t>& corpora, const std::vector<double>& compile_times) {
+	using table_t = typename matcher_t::table_t;
+	const std::vector<std::string_view> strings = split_spec(spec);
+
+	char compile_time[32] = "-";
+	if (matcher_index < compile_times.size() && compile_times[matcher_index] >= 0) {
+		std::snprintf(compile_time, sizeof(compile_time), "%.0fms", compile_times[matcher_index]);
+	}
+	std::printf("\n%s: %zu strings, %zu states, %zu classes, table %zu bytes, compile time %s\n", matcher_name, strings.size(),
+		    table_t::length, table_t::class_count, sizeof(table_t), compile_time);
+	std::printf("%-12s %-14s %-12s %9s %9s %14s %12s\n", "corpus", "matcher", "engine", "GB/s", "ns/byte", "matches/s", "matches");
+
+	std::vector<corpus_t> matcher_corpora = corpora;
+	matcher_corpora.push_back({ "dense", generate_dense_text(strings) });
+
+	for (const corpus_t& corpus : matcher_corpora) {
+		const char* const begin = corpus.data.data();
+		const char* const end = begin + corpus.data.size();
+		size_t match_count;
+
+		double seconds = measure([&] {
+			matcher.full_reset();
+			return matcher.scan(begin, end);
+		}, match_count);
+		print_result(corpus.name, matcher_name, "matcher", corpus.data.size(), seconds, match_count);
+		const size_t matcher_match_count = match_count;
+
+		if (strings.size() <= find_loop_max_string_count) {
+			seconds = measure([&] {
+				size_t result = 0;
+				const std::string_view corpus_view(corpus.data);
+				for (std::string_view string : strings) {
+					for (size_t position = corpus_view.find(string); position != std::string_view::npos; position = corpus_view.find(string, position + 1)) {
+						result++;
+					}
+				}
+				return result;
+			}, match_count);
+			print_result(corpus.name, matcher_name, "find loop", corpus.data.size(), seconds, match_count);
+			if (match_count != matcher_match_count) { std::printf("MISMATCH: the matcher found %zu matches, the find loop %zu\n", matcher_match_count, match_count); }
+
+			std::string pattern;
+			for (std::string_view string : strings) {
+				if (!pattern.empty()) { pattern += '|'; }
+				pattern += escape_for_regex(string);
+			}
+			const std::regex regex(pattern, std::regex::optimize);
+			const size_t regex_size = std::min(corpus.data.size(), regex_corpus_size);
+			seconds = measure([&] {
+				return (size_t)std::distance(std::cregex_iterator(begin, begin + regex_size, regex), std::cregex_iterator());
+			}, match_count);
+			print_result(corpus.name, matcher_name, "std::regex", regex_size, seconds, match_count);
+		}
+	}
+}
+
+#define BENCHMARK_MATCHER(matcher_name, matcher_index) benchmark_matcher(#matcher_name, matcher_index, matcher_name, \
+									 matcher_name ## _SPEC_DO_NOT_TOUCH, corpora, compile_times)
+
+int main(int argc, const char* const* argv) {
+	const std::vector<double> compile_times = read_compile_times(argc > 1 ? argv[1] : nullptr);
+
+	std::vector<corpus_t> corpora;
+	corpora.push_back({ "random", generate_random_bytes() });
+	corpora.push_back({ "log", generate_log_text() });
+
+	BENCHMARK_MATCHER(log_keywords, 0);
+	BENCHMARK_MATCHER(words_8x4, 1);
+	BENCHMARK_MATCHER(words_8x16, 2);
+	BENCHMARK_MATCHER(words_64x8, 3);
+	BENCHMARK_MATCHER(words_256x6, 4);
+	BENCHMARK_MATCHER(words_128x12, 5);
+}
+
+#endif
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 
 #include "meta_string_match.h"
@@ -7,7 +8,7 @@ using size_t = std::size_t;
 void test_func(size_t) noexcept { }
 
 const char* matched_string;
-CREATE_META_STRING_MATCHER(string_matcher, "hi|hi2|hi3|hi33|hi44|\\||\\|| ||||||\\\\|", 
+CREATE_META_STRING_MATCHER_WITH_STATS(string_matcher, "hi|hi2|hi3|hi33|hi44|\\||\\|| ||||||\\\\|", 
 		[](size_t) { matched_string = "hi"; }, 
 		[](size_t) { matched_string = "hi2"; }, 
 		[](size_t) { matched_string = "hi3"; }, 
@@ -26,14 +27,40 @@ CREATE_META_STRING_MATCHER(string_matcher, "hi|hi2|hi3|hi33|hi44|\\||\\|| ||||||
 		);
 
 void output_table() noexcept {
-	for (size_t y = 0; y < decltype(string_matcher)::length; y++) {
-		for (size_t x = 0; x < (unsigned char)-1; x++) {
-			size_t thing = ((string_matcher.data[y][x].next_state_ptr - string_matcher.data[0]) / ((size_t)(unsigned char)-1 + 1));
-			if (string_matcher.data[y][x].next_state_ptr == nullptr) { thing = 0; }
-			std::cout << " { " << thing << ", " << string_matcher.data[y][x].callback << " } ";
+	constexpr const auto& table = decltype(string_matcher)::table;
+	for (size_t y = 0; y < table.length; y++) {
+		for (size_t x = 0; x < table.class_count; x++) {
+			std::cout << ' ' << (size_t)table.data[y * table.class_count + x] / table.class_count;
 		}
+		if (table.is_accepting(y * table.class_count)) {
+			std::cout << "  => match id " << (size_t)table.match_ids[y] << ", output link " << (size_t)table.output_links[y] / table.class_count;
+		}
+		std::cout << "\n";
+	}
+}
+
+// NOTE: What the matcher did with the input, from it's stats: the states it spent it's time in (the hottest first, the ones it never
+// visited are left out), how often it fell back to the root and how often every string matched.
+void output_stats() noexcept {
+	constexpr const auto& table = decltype(string_matcher)::table;
+	const auto stats = string_matcher.stats_snapshot();
+
+	std::cout << "\ncharacters: " << stats.character_count << ", skipped by the prefilter: " << stats.skipped_character_count
+		  << ", root resets: " << stats.root_reset_count << "\n";
+
+	size_t states_by_visits[table.length];
+	for (size_t state_index = 0; state_index < table.length; state_index++) { states_by_visits[state_index] = state_index; }
+	std::sort(states_by_visits, states_by_visits + table.length, [&stats](size_t a, size_t b) { return stats.state_visit_counts[a] > stats.state_visit_counts[b]; });
+	for (const size_t state_index : states_by_visits) {
+		if (stats.state_visit_counts[state_index] == 0) { break; }
+		std::cout << "state " << state_index << ": " << stats.state_visit_counts[state_index] << " visits";
+		if (table.is_accepting(state_index * table.class_count)) { std::cout << " (accepting)"; }
 		std::cout << "\n";
 	}
+
+	for (size_t match_id = 0; match_id < table.match_count; match_id++) {
+		std::cout << "match id " << match_id << ": " << stats.match_counts[match_id] << " matches\n";
+	}
 }
 
 int main() {
@@ -45,4 +72,6 @@ int main() {
 			std::cout << "match detected => " << matched_string << '\n'; 
 		}
 	}
+
+	output_stats();
 }
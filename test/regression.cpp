@@ -0,0 +1,525 @@
+#include <algorithm>
+#include <bitset>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "meta_string_match.h"
+#include "meta_string_match_parallel.h"
+#include "meta_string_match_runtime.h"
+
+using size_t = std::size_t;
+
+/*
+   NOTE: Regression tests, run them with make test. Every spec here gets compared against a dumb reference matcher (every string at every
+   position, straight from the spec) on a couple of inputs, through every way there is to run a table: the matcher CREATE_META_STRING_MATCHER
+   picks, string_matcher_t itself, match_character, feed in small chunks, a cursor, string_matcher_switch_t, find_matches and so on.
+   All of them have to report exactly the same matches in exactly the same order (longest first, spec order for strings of the same length).
+   The specs are mostly strings that end in the same trie node without being the same string (a class and a literal that overlap),
+   which used to lose one of the two match ids. The long inputs are there for the prefilter in scan, which only kicks in after a couple
+   of bytes (see string_matcher_table_t::scan), so they have candidates in front of, in the middle of and after long stretches it can skip.
+   The other checks are for the things that don't fit into that (parallel_scan, scan_interleaved, lookup and so on), they compare against
+   a plain scan or against what the answer has to be.
+*/
+
+struct match_record_t {
+	size_t position;
+	size_t match_id;
+
+	bool operator==(const match_record_t&) const = default;
+};
+
+std::vector<match_record_t> recorded_matches;
+
+template <size_t match_id>
+void record_match(size_t position) noexcept { recorded_matches.push_back({ position, match_id }); }
+
+template <const meta::const_string& spec, size_t... match_ids>
+consteval auto create_recording_callbacks(std::index_sequence<match_ids...>) {
+	return meta::create_string_matcher_callbacks<spec>(record_match<match_ids>...);
+}
+
+// NOTE: The same thing for string_matcher_with_handlers_t, with handlers that capture where they record to.
+template <const auto& table, size_t... match_ids>
+auto create_recording_matcher_with_handlers(std::vector<match_record_t>& matches, std::index_sequence<match_ids...>) {
+	return meta::create_string_matcher_with_handlers<table>([&matches](size_t position) { matches.push_back({ position, match_ids }); }...);
+}
+
+// NOTE: The spec as the reference matcher sees it: every byte an element matches, straight from for_each_element_byte, and the |'s.
+// for_each_element_byte is consteval, so this happens at compile-time, and reference_strings turns it into something easier to work with.
+struct reference_element_t {
+	bool is_separator = false;
+	uint64_t bytes[4] { };
+};
+
+template <size_t capacity>
+struct reference_spec_t {
+	size_t element_count = 0;
+	reference_element_t elements[capacity];
+};
+
+template <const meta::const_string& spec>
+consteval reference_spec_t<spec.length> parse_reference_spec() {
+	reference_spec_t<spec.length> result;
+	for (size_t i = 0; i < spec.length; ) {
+		reference_element_t& element = result.elements[result.element_count++];
+		if (spec[i] == '|') {
+			element.is_separator = true;
+			i++;
+			continue;
+		}
+		i = meta::for_each_element_byte(spec, i, [&element](unsigned char character) { element.bytes[character / 64] |= (uint64_t)1 << (character % 64); });
+	}
+	return result;
+}
+
+// NOTE: The strings of the spec as one byte set per element, nothing else. Identical strings (the same byte sets) collapse into the last one.
+template <const meta::const_string& spec>
+std::vector<std::vector<std::bitset<256>>> reference_strings() {
+	static constexpr reference_spec_t<spec.length> reference_spec = parse_reference_spec<spec>();
+	std::vector<std::vector<std::bitset<256>>> result(1);
+	for (size_t i = 0; i < reference_spec.element_count; i++) {
+		const reference_element_t& element = reference_spec.elements[i];
+		if (element.is_separator) {
+			result.emplace_back();
+			continue;
+		}
+		std::bitset<256> element_bytes;
+		for (size_t character = 0; character < 256; character++) { element_bytes[character] = (element.bytes[character / 64] >> (character % 64)) & 1; }
+		result.back().push_back(element_bytes);
+	}
+	for (size_t match_id = 0; match_id < result.size(); match_id++) {
+		for (size_t later_match_id = match_id + 1; later_match_id < result.size(); later_match_id++) {
+			if (result[later_match_id] == result[match_id]) { result[match_id].clear(); }
+		}
+	}
+	return result;
+}
+
+template <const meta::const_string& spec>
+std::vector<match_record_t> reference_matches(const std::string& input) {
+	const std::vector<std::vector<std::bitset<256>>> strings = reference_strings<spec>();
+	std::vector<std::pair<size_t, size_t>> ends_by_length;		// NOTE: (length, match id), longest first, then spec order
+	for (size_t match_id = 0; match_id < strings.size(); match_id++) { ends_by_length.push_back({ strings[match_id].size(), match_id }); }
+	std::stable_sort(ends_by_length.begin(), ends_by_length.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+	std::vector<match_record_t> result;
+	for (size_t position = 0; position < input.size(); position++) {
+		for (const auto& [length, match_id] : ends_by_length) {
+			if (length == 0 || length > position + 1) { continue; }
+			bool is_match = true;
+			for (size_t j = 0; j < length && is_match; j++) { is_match = strings[match_id][j].test((unsigned char)input[position + 1 - length + j]); }
+			if (is_match) { result.push_back({ position, match_id }); }
+		}
+	}
+	return result;
+}
+
+size_t failure_count = 0;
+
+// NOTE: Long inputs get cut off, nobody wants to see 4000 dashes.
+void check(const char* spec_text, const std::string& input, const char* what, const std::vector<match_record_t>& expected, const std::vector<match_record_t>& actual) {
+	if (actual == expected) { return; }
+	failure_count++;
+	std::printf("FAILED: \"%s\" on \"%.40s\" (%zu bytes) with %s: expected %zu matches, got %zu\n", spec_text, input.c_str(), input.size(), what,
+		    expected.size(), actual.size());
+}
+
+void check_value(const char* spec_text, const char* what, size_t expected, size_t actual) {
+	if (actual == expected) { return; }
+	failure_count++;
+	std::printf("FAILED: \"%s\": %s is %zu, expected %zu\n", spec_text, what, actual, expected);
+}
+
+template <typename table_t>
+std::vector<match_record_t> find_all_matches(const table_t& table, const std::string& input) {
+	std::vector<match_record_t> result;
+	size_t state = 0;
+	size_t input_stream_position = 0;
+	const char* begin = input.data();
+	meta::string_match_t matches[64];
+	while (begin != input.data() + input.size()) {
+		const size_t match_count = table.find_matches(state, input_stream_position, begin, input.data() + input.size(), matches, 64);
+		for (size_t i = 0; i < match_count; i++) { result.push_back({ matches[i].end - 1, matches[i].match_id }); }
+	}
+	return result;
+}
+
+// NOTE: Scans the first split bytes with one matcher, moves the stream over to the other one with save_stream_state and
+// restore_stream_state and scans the rest with that one.
+template <typename first_matcher_t, typename second_matcher_t>
+std::vector<match_record_t> scan_with_handover(const std::string& input, size_t split) {
+	recorded_matches.clear();
+	first_matcher_t first_matcher;
+	first_matcher.scan(input.data(), input.data() + split);
+	second_matcher_t second_matcher;
+	if (!second_matcher.restore_stream_state(first_matcher.save_stream_state())) {
+		failure_count++;
+		std::printf("FAILED: restore_stream_state refused a state that save_stream_state gave it\n");
+	}
+	second_matcher.scan(input.data() + split, input.data() + input.size());
+	return recorded_matches;
+}
+
+template <const meta::const_string& spec>
+void check_spec(const std::vector<std::string>& inputs) {
+	static constexpr auto table = meta::create_string_matcher_table<spec>();
+	static constexpr auto callbacks = create_recording_callbacks<spec>(std::make_index_sequence<meta::calculate_string_count(spec)>());
+	const std::string spec_text(spec.data, spec.length);
+
+	meta::runtime_string_matcher_table_t<uint32_t> runtime_table;
+	if (!meta::build_runtime_string_matcher_table(spec, runtime_table)) {
+		failure_count++;
+		std::printf("FAILED: \"%s\" doesn't build at runtime\n", spec_text.c_str());
+	}
+	// NOTE: Loaded from a copy, so that it really only has the serialized form to go on. uint64_t for the alignment.
+	std::vector<uint64_t> serialized_table((runtime_table.serialized_table().size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+	std::memcpy(serialized_table.data(), runtime_table.serialized_table().data(), runtime_table.serialized_table().size());
+	meta::runtime_string_matcher_table_t<uint32_t> loaded_table;
+	if (!meta::load_runtime_string_matcher_table(std::span<const unsigned char>((const unsigned char*)serialized_table.data(), runtime_table.serialized_table().size()),
+						     loaded_table)) {
+		failure_count++;
+		std::printf("FAILED: \"%s\" doesn't load after serializing it\n", spec_text.c_str());
+	}
+
+	for (const std::string& input : inputs) {
+		const std::vector<match_record_t> expected = reference_matches<spec>(input);
+
+		recorded_matches.clear();
+		meta::string_matcher_for_spec_t<spec, table, callbacks> default_matcher;
+		default_matcher.scan(input.data(), input.data() + input.size());
+		check(spec_text.c_str(), input, "the default matcher", expected, recorded_matches);
+
+		recorded_matches.clear();
+		meta::string_matcher_t<table, callbacks> table_matcher;
+		table_matcher.scan(input.data(), input.data() + input.size());
+		check(spec_text.c_str(), input, "scan", expected, recorded_matches);
+
+		recorded_matches.clear();
+		table_matcher.full_reset();
+		for (const char character : input) { table_matcher.match_character(character); }
+		check(spec_text.c_str(), input, "match_character", expected, recorded_matches);
+
+		recorded_matches.clear();
+		table_matcher.full_reset();
+		for (size_t i = 0; i < input.size(); i += 3) { table_matcher.feed(std::span<const char>(input).subspan(i, std::min<size_t>(3, input.size() - i))); }
+		table_matcher.finish();
+		check(spec_text.c_str(), input, "feed", expected, recorded_matches);
+
+		recorded_matches.clear();
+		auto cursor = table_matcher.create_cursor();
+		cursor.scan(input.data(), input.data() + input.size());
+		check(spec_text.c_str(), input, "a cursor", expected, recorded_matches);
+
+		recorded_matches.clear();
+		meta::string_matcher_switch_t<table, callbacks> switch_matcher;
+		switch_matcher.scan(input.data(), input.data() + input.size());
+		check(spec_text.c_str(), input, "the switch matcher", expected, recorded_matches);
+
+		check(spec_text.c_str(), input, "find_matches", expected, find_all_matches(table, input));
+
+		std::vector<match_record_t> handler_matches;
+		auto handler_matcher = create_recording_matcher_with_handlers<table>(handler_matches, std::make_index_sequence<meta::calculate_string_count(spec)>());
+		handler_matcher.scan(input.data(), input.data() + input.size());
+		check(spec_text.c_str(), input, "capturing handlers", expected, handler_matches);
+
+		check(spec_text.c_str(), input, "a runtime table", expected, find_all_matches(runtime_table, input));
+		check(spec_text.c_str(), input, "a loaded runtime table", expected, find_all_matches(loaded_table, input));
+
+		// NOTE: The stream states of the bit-parallel matcher are the table's, so a stream can move from one to the other in the middle.
+		if constexpr (meta::is_bit_parallel_usable(spec)) {
+			using bit_parallel_matcher_t = meta::string_matcher_bit_parallel_t<spec, table, callbacks>;
+			using table_matcher_t = meta::string_matcher_t<table, callbacks>;
+			for (size_t split = 0; split <= input.size(); split += input.size() <= 32 ? 1 : input.size() / 7) {
+				check(spec_text.c_str(), input, "bit-parallel to table", expected, scan_with_handover<bit_parallel_matcher_t, table_matcher_t>(input, split));
+				check(spec_text.c_str(), input, "table to bit-parallel", expected, scan_with_handover<table_matcher_t, bit_parallel_matcher_t>(input, split));
+			}
+		}
+	}
+}
+
+#define REGRESSION_SPEC(name, ...) static constexpr meta::const_string name = meta::const_string(__VA_ARGS__)
+
+// NOTE: Some input that the prefilter can skip, a long stretch of it, longer than any vector the prefilter uses.
+std::string filler(size_t length) { return std::string(length, '-'); }
+
+REGRESSION_SPEC(class_and_literal, "a.c|abc", meta::character_classes);
+REGRESSION_SPEC(two_classes_and_literal, "[0-9][0-9]|12", meta::character_classes);
+REGRESSION_SPEC(class_in_the_middle, "ab|[a-c]b|q", meta::character_classes);
+REGRESSION_SPEC(lots_of_overlap, "[ab]c|ac|a.|[0-9][0-9]|12|1", meta::character_classes);
+REGRESSION_SPEC(identical_strings, "abc|abc|bc");
+REGRESSION_SPEC(identical_case_insensitive_strings, "ab|AB|aB|b", meta::case_insensitive);
+REGRESSION_SPEC(plain_overlap, "he|she|his|hers");
+REGRESSION_SPEC(long_strings, "needle|needles|eel|haystack");
+
+// NOTE: parallel_scan has to give exactly what a plain scan gives, in the same order, including the matches that straddle
+// the boundaries between the chunks. Every chunk after the first one starts longest_match_length - 1 characters early, so there's a match
+// that starts exactly that far in front of a boundary, one that starts right in front of it and one in between.
+REGRESSION_SPEC(parallel_spec, "abcdefgh|gh|cd|x");
+
+void check_parallel_scan() {
+	static constexpr auto table = meta::create_string_matcher_table<parallel_spec>();
+	static constexpr auto callbacks = create_recording_callbacks<parallel_spec>(std::make_index_sequence<meta::calculate_string_count(parallel_spec)>());
+	const std::string spec_text(parallel_spec.data, parallel_spec.length);
+
+	constexpr size_t thread_count = 4;
+	std::string buffer(4 * 64 * 1024 + 123, '.');
+	for (size_t i = 0; i < buffer.size(); i += 997) { buffer[i] = 'x'; }
+	std::memcpy(&buffer[0], "efgh", 4);
+	const size_t chunk_size = buffer.size() / thread_count;
+	const size_t straddle_offsets[thread_count - 1] = { table.longest_match_length - 1, 1, 4 };
+	for (size_t chunk_index = 1; chunk_index < thread_count; chunk_index++) {
+		std::memcpy(&buffer[chunk_index * chunk_size - straddle_offsets[chunk_index - 1]], "abcdefgh", 8);
+	}
+
+	// NOTE: Once from the root, once from the middle of a stream (with the beginning of a match in front of the buffer).
+	for (const size_t stream_start : { 0, 4 }) {
+		const std::string stream_input = std::string("abcd").substr(0, stream_start) + buffer;
+
+		recorded_matches.clear();
+		meta::string_matcher_t<table, callbacks> plain_matcher;
+		plain_matcher.scan(stream_input.data(), stream_input.data() + stream_start);
+		meta::string_matcher_t<table, callbacks> parallel_matcher = plain_matcher;
+		recorded_matches.clear();
+		plain_matcher.scan(stream_input.data() + stream_start, stream_input.data() + stream_input.size());
+		const std::vector<match_record_t> expected = recorded_matches;
+
+		size_t straddling_match_count = 0;
+		for (const match_record_t& match : expected) { straddling_match_count += match.match_id == 0; }
+		check_value(spec_text.c_str(), "number of straddling matches in the plain scan", thread_count - 1 + (stream_start != 0), straddling_match_count);
+
+		recorded_matches.clear();
+		const size_t match_count = meta::parallel_scan(parallel_matcher, stream_input.data() + stream_start, stream_input.data() + stream_input.size(), thread_count);
+		check(spec_text.c_str(), stream_input, "parallel_scan", expected, recorded_matches);
+		check_value(spec_text.c_str(), "parallel_scan's match count", expected.size(), match_count);
+		check_value(spec_text.c_str(), "the state after parallel_scan", plain_matcher.state, parallel_matcher.state);
+		check_value(spec_text.c_str(), "the input stream position after parallel_scan", plain_matcher.input_stream_position, parallel_matcher.input_stream_position);
+	}
+}
+
+// NOTE: scan_interleaved with buffers of different lengths, every stream has it's own strings, so the matches can be told apart. Every stream
+// has to get exactly what scanning it on it's own gives it, the part that's interleaved (as long as the shortest buffer) and the rest.
+REGRESSION_SPEC(interleaved_spec, "abc|bc|xyz|xy|mn|n");
+
+void check_scan_interleaved(const std::string (&inputs)[4]) {
+	static constexpr auto table = meta::create_string_matcher_table<interleaved_spec>();
+	static constexpr auto callbacks = create_recording_callbacks<interleaved_spec>(std::make_index_sequence<meta::calculate_string_count(interleaved_spec)>());
+	const std::string spec_text(interleaved_spec.data, interleaved_spec.length);
+	using matcher_t = meta::string_matcher_t<table, callbacks>;
+
+	constexpr size_t stream_count = 4;
+	const size_t stream_match_ids[stream_count][2] = { { 0, 1 }, { 2, 3 }, { (size_t)-1, (size_t)-1 }, { 4, 5 } };
+
+	matcher_t matchers[stream_count];
+	matcher_t* const matcher_pointers[stream_count] = { &matchers[0], &matchers[1], &matchers[2], &matchers[3] };
+	const std::span<const char> buffers[stream_count] = { inputs[0], inputs[1], inputs[2], inputs[3] };
+	recorded_matches.clear();
+	const size_t match_count = matcher_t::scan_interleaved(matcher_pointers, buffers);
+	const std::vector<match_record_t> interleaved_matches = recorded_matches;
+	check_value(spec_text.c_str(), "scan_interleaved's match count", interleaved_matches.size(), match_count);
+
+	for (size_t stream_index = 0; stream_index < stream_count; stream_index++) {
+		recorded_matches.clear();
+		matcher_t plain_matcher;
+		plain_matcher.scan(inputs[stream_index].data(), inputs[stream_index].data() + inputs[stream_index].size());
+		std::vector<match_record_t> stream_matches;
+		for (const match_record_t& match : interleaved_matches) {
+			if (match.match_id == stream_match_ids[stream_index][0] || match.match_id == stream_match_ids[stream_index][1]) { stream_matches.push_back(match); }
+		}
+		check(spec_text.c_str(), inputs[stream_index], "scan_interleaved", recorded_matches, stream_matches);
+		check_value(spec_text.c_str(), "the state after scan_interleaved", plain_matcher.state, matchers[stream_index].state);
+		check_value(spec_text.c_str(), "the input stream position after scan_interleaved", plain_matcher.input_stream_position,
+			    matchers[stream_index].input_stream_position);
+	}
+}
+
+// NOTE: lookup only takes whole tokens: a string that's the end of a longer string, a prefix, an empty token and a token that's longer
+// than any string are all nothing, even if they contain a match.
+REGRESSION_SPEC(lookup_spec, "he|she|his|hers|h");
+REGRESSION_SPEC(lookup_class_spec, "a.c|abc|[0-9]", meta::character_classes);
+
+void check_lookup() {
+	static constexpr auto table = meta::create_string_matcher_table<lookup_spec>();
+	static constexpr auto callbacks = create_recording_callbacks<lookup_spec>(std::make_index_sequence<meta::calculate_string_count(lookup_spec)>());
+	using matcher_t = meta::string_matcher_t<table, callbacks>;
+	constexpr size_t no_match_id = std::remove_cvref_t<decltype(table)>::no_match_id;
+
+	static_assert(matcher_t::lookup("she") == 1, "lookup has to work at compile-time");
+	const std::pair<const char*, size_t> tokens[] = {
+		{ "he", 0 }, { "she", 1 }, { "his", 2 }, { "hers", 3 }, { "h", 4 },
+		{ "e", no_match_id }, { "is", no_match_id }, { "ers", no_match_id },		// NOTE: suffixes of longer strings
+		{ "sh", no_match_id }, { "her", no_match_id },					// NOTE: prefixes
+		{ "the", no_match_id }, { "ushe", no_match_id },					// NOTE: tokens that end in a string
+		{ "", no_match_id }, { "hershe", no_match_id }, { "ushers", no_match_id }, { "x", no_match_id }
+	};
+	for (const auto& [token, match_id] : tokens) {
+		const std::string what = std::string("lookup(\"") + token + "\")";
+		check_value("he|she|his|hers|h", what.c_str(), match_id, matcher_t::lookup(token));
+	}
+
+	recorded_matches.clear();
+	const bool was_called = matcher_t::lookup_and_call("his") && !matcher_t::lookup_and_call("hi");
+	check_value("he|she|his|hers|h", "lookup_and_call", true, was_called);
+	check("he|she|his|hers|h", "his", "lookup_and_call", { { 2, 2 } }, recorded_matches);
+
+	// NOTE: A token that's two strings at once gives the first one in the spec.
+	static constexpr auto class_table = meta::create_string_matcher_table<lookup_class_spec>();
+	check_value("a.c|abc|[0-9]", "lookup(\"abc\")", 0, class_table.lookup("abc"));
+	check_value("a.c|abc|[0-9]", "lookup(\"a-c\")", 0, class_table.lookup("a-c"));
+	check_value("a.c|abc|[0-9]", "lookup(\"7\")", 2, class_table.lookup("7"));
+	check_value("a.c|abc|[0-9]", "lookup(\"77\")", no_match_id, class_table.lookup("77"));
+}
+
+// NOTE: load_runtime_string_matcher_table has to refuse anything that isn't exactly what build_runtime_string_matcher_table writes,
+// and leave the table it's loading into alone when it does.
+REGRESSION_SPEC(runtime_spec, "he|she|his|hers");
+
+void check_runtime_table_loading() {
+	const char* const spec_text = "he|she|his|hers";
+	meta::runtime_string_matcher_table_t<uint32_t> runtime_table;
+	if (!meta::build_runtime_string_matcher_table(runtime_spec, runtime_table)) {
+		failure_count++;
+		std::printf("FAILED: \"%s\" doesn't build at runtime\n", spec_text);
+		return;
+	}
+	const size_t blob_size = runtime_table.serialized_table().size();
+	std::vector<uint64_t> pristine_blob((blob_size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+	std::memcpy(pristine_blob.data(), runtime_table.serialized_table().data(), blob_size);
+
+	std::vector<uint64_t> blob;
+	const auto blob_bytes = [&blob]() { return (unsigned char*)blob.data(); };
+	const auto header = [&blob]() { return (meta::runtime_string_matcher_table_header_t*)blob.data(); };
+	const auto states = [&blob, &header]() { return (uint32_t*)((unsigned char*)blob.data() + sizeof(meta::runtime_string_matcher_table_header_t)); };
+	const size_t state_end = runtime_table.length * runtime_table.class_count;
+
+	const auto check_loading = [&](const char* what, size_t size, const char* expected_error) {
+		meta::runtime_string_matcher_table_t<uint32_t> loaded_table;
+		const char* error = nullptr;
+		const bool is_loaded = meta::load_runtime_string_matcher_table(std::span<const unsigned char>(blob_bytes(), size), loaded_table, &error);
+		const bool is_expected = expected_error ? !is_loaded && error && std::strcmp(error, expected_error) == 0 && loaded_table.length == 0 : is_loaded;
+		if (is_expected) { return; }
+		failure_count++;
+		std::printf("FAILED: \"%s\": loading %s gave \"%s\", expected \"%s\"\n", spec_text, what, is_loaded ? "success" : error, expected_error ? expected_error : "success");
+	};
+	const auto reset_blob = [&]() { blob = pristine_blob; };
+
+	reset_blob();
+	check_loading("the untouched blob", blob_size, nullptr);
+	check_loading("an empty blob", 0, "serialized table is truncated");
+	check_loading("half a header", sizeof(meta::runtime_string_matcher_table_header_t) / 2, "serialized table is truncated");
+	check_loading("a truncated blob", blob_size - sizeof(uint32_t), "serialized table has the wrong size");
+	header()->magic[0] = 'X';
+	check_loading("a blob with the wrong magic", blob_size, "not a serialized string matcher table");
+	reset_blob();
+	header()->format_version++;
+	check_loading("a blob with the wrong format version", blob_size, "serialized table has the wrong format version (or byte order)");
+	reset_blob();
+	header()->element_size = sizeof(uint16_t);
+	check_loading("a blob with the wrong element size", blob_size, "serialized table was built with a different state_t");
+	reset_blob();
+	header()->class_count = 0;
+	check_loading("a blob without classes", blob_size, "serialized table has invalid dimensions");
+	reset_blob();
+	header()->length = (uint64_t)-1 / 2;
+	check_loading("a blob with a huge length", blob_size, "serialized table has the wrong size");
+	reset_blob();
+	header()->byte_classes['q'] = (unsigned char)header()->class_count;
+	check_loading("a blob with an out of range byte class", blob_size, "serialized table has an invalid byte class");
+	reset_blob();
+	states()[1] = (uint32_t)state_end;
+	check_loading("a blob with an out of range state", blob_size, "serialized table has an invalid element");
+	reset_blob();
+	states()[1] = 1;
+	check_loading("a blob with a state that isn't a row offset", blob_size, "serialized table has an invalid element");
+	reset_blob();
+	header()->first_accepting_state = state_end;
+	check_loading("a blob with out of range accepting states", blob_size, "serialized table has invalid accepting states");
+	reset_blob();
+	states()[state_end + runtime_table.length + runtime_table.length - 1] = (uint32_t)(runtime_table.length * runtime_table.class_count);
+	check_loading("a blob with an out of range output link", blob_size, "serialized table has an invalid output chain");
+	reset_blob();
+	states()[state_end + runtime_table.length - 1] = (uint32_t)runtime_table.match_count;
+	check_loading("a blob with an out of range match id", blob_size, "serialized table has an invalid output chain");
+	reset_blob();
+	header()->first_bytes[0] = 'x';
+	check_loading("a blob with the wrong prefilter bytes", blob_size, "serialized table has an invalid prefilter");
+	reset_blob();
+	header()->first_byte_count = meta::string_matcher_prefilter_max_first_byte_count + 1;
+	check_loading("a blob with the wrong prefilter byte count", blob_size, "serialized table has an invalid prefilter");
+}
+
+// NOTE: The stats on an input where every number is known: 100 bytes of filler, "ushers", 100 bytes of filler. The prefilter (the first
+// bytes are h and s) skips the filler and the u, the only transitions it leaves are s, h, e, r, s and the first byte of filler after them,
+// which is the one root reset. Without the prefilter (match_character), every byte is a transition.
+REGRESSION_SPEC(stats_spec, "he|she|his|hers");
+
+void check_stats() {
+	static constexpr auto table = meta::create_string_matcher_table<stats_spec>();
+	static constexpr auto callbacks = create_recording_callbacks<stats_spec>(std::make_index_sequence<meta::calculate_string_count(stats_spec)>());
+	using table_t = std::remove_cvref_t<decltype(table)>;
+	using matcher_t = meta::string_matcher_t<table, callbacks, meta::string_matcher_stats_t<table_t>>;
+	const char* const spec_text = "he|she|his|hers";
+	const std::string input = filler(100) + "ushers" + filler(100);
+
+	const auto check_stats_snapshot = [&](const char* what, const matcher_t& matcher, size_t skipped_character_count, size_t root_visit_count) {
+		const meta::string_matcher_stats_t<table_t> stats = matcher.stats_snapshot();
+		const std::string prefix = std::string(what) + ": ";
+		check_value(spec_text, (prefix + "character_count").c_str(), input.size(), stats.character_count);
+		check_value(spec_text, (prefix + "skipped_character_count").c_str(), skipped_character_count, stats.skipped_character_count);
+		check_value(spec_text, (prefix + "root_reset_count").c_str(), 1, stats.root_reset_count);
+		size_t visit_count = 0;
+		for (const uint64_t state_visit_count : stats.state_visit_counts) { visit_count += state_visit_count; }
+		check_value(spec_text, (prefix + "the sum of state_visit_counts").c_str(), input.size() - skipped_character_count, visit_count);
+		check_value(spec_text, (prefix + "state_visit_counts of the root").c_str(), root_visit_count, stats.state_visit_counts[0]);
+		const size_t expected_match_counts[table_t::match_count] = { 1, 1, 0, 1 };
+		for (size_t match_id = 0; match_id < table_t::match_count; match_id++) {
+			check_value(spec_text, (prefix + "match_counts[" + std::to_string(match_id) + "]").c_str(), expected_match_counts[match_id], stats.match_counts[match_id]);
+		}
+	};
+
+	matcher_t matcher;
+	matcher.scan(input.data(), input.data() + input.size());
+	check_stats_snapshot("scan (with the prefilter)", matcher, 200, 1);
+
+	matcher.full_reset();
+	matcher.reset_stats();
+	for (const char character : input) { matcher.match_character(character); }
+	check_stats_snapshot("match_character (without the prefilter)", matcher, 0, 201);
+}
+
+int main() {
+	check_spec<class_and_literal>({ "abc", "axc abc abcabc", "ac bc", filler(40) + "abc" + filler(3000) + "a-c" + filler(17) + "abcabc",
+					"a" + filler(100) + "abc" + std::string(200, 'a') + "c" + filler(64) + "axc" });
+	check_spec<two_classes_and_literal>({ "12", "0123456789", "1212x12" });
+	check_spec<class_in_the_middle>({ "ab", "bb cb abq", "qab" });
+	check_spec<lots_of_overlap>({ "ac", "bc12 a1 12ac", "1", "aac" });
+	check_spec<identical_strings>({ "abc", "abcbc", filler(33) + "abc" + filler(65) + "bcabc" });
+	check_spec<identical_case_insensitive_strings>({ "ab", "AbaBB", filler(70) + "aB" + filler(1000) + "BbAb" });
+	check_spec<plain_overlap>({ "ushers", "shershis", filler(16) + "ushers" + filler(15) + "his" + filler(300) + "she" });
+	// NOTE: Candidates every couple of bytes (the e's), so that the prefilter backs off, then a long stretch without any.
+	std::string backoff_input;
+	for (size_t i = 0; i < 40; i++) { backoff_input += "e-ee-needl"; }
+	check_spec<long_strings>({ filler(1) + "needles" + filler(4096) + "haystack", backoff_input + "needle" + filler(500) + "eel" + filler(129) + "needles",
+				   "haystackneedleseel" + filler(63) + "h" + filler(64) + "haystack" + filler(65) });
+	// NOTE: More matches than find_all_matches has room for, so that find_matches has to stop and pick up where it left off.
+	std::string dense_input;
+	for (size_t i = 0; i < 50; i++) { dense_input += "ushershis"; }
+	check_spec<plain_overlap>({ dense_input });
+	check_parallel_scan();
+	const std::string long_interleaved_input = std::string(300, '.') + "xyz" + std::string(50, 'x') + "xyzy";
+	check_scan_interleaved({ "abcabc..bc.ab", long_interleaved_input, "..ab..", "mnn" });
+	check_scan_interleaved({ "abcabc..bc.ab", long_interleaved_input, "", "mnn" });
+	check_lookup();
+	check_runtime_table_loading();
+	check_stats();
+
+	if (failure_count != 0) {
+		std::printf("%zu checks failed\n", failure_count);
+		return 1;
+	}
+	std::printf("all regression checks passed\n");
+	return 0;
+}